@@ -0,0 +1,410 @@
+/*
+ * Microbenchmarks for the pico_fft hot paths, built for the Pico (fft_bench
+ * in the top-level CMakeLists.txt, results over USB) and for Linux (the host
+ * build). Prints CSV, one line per benchmark, so runs from two commits can be
+ * diffed:
+ *
+ *   benchmark,iterations,ns_per_frame,frames_per_s,cycles_per_frame
+ *
+ * Each benchmark runs for at least BENCH_MIN_US. On the Pico the cycles come
+ * from SysTick around every call, or from the 1 MHz timer for calls longer
+ * than SysTick's 24-bit range; on the host they are left empty. Benchmarks
+ * whose buffers do not fit in RAM report 0 iterations. A last '#' line gives
+ * the number of Goertzel filters that costs as much as the FFT and a bin bank.
+ */
+#include "pico/stdlib.h"
+#include "pico/fft.h"
+#include "pico/fft_pitch.h"
+#include "pico/fft_goertzel.h"
+#include "fft_stages.h"
+#include "hardware/i2c.h"
+#include "oled.h"
+#include <stdlib.h>
+#include <string.h>
+#if PICO_ON_DEVICE
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+#include "pico/stdio_usb.h"
+#define BENCH_PLATFORM "rp2040"
+#else
+#define BENCH_PLATFORM "host"
+#endif
+
+#define BENCH_MIN_US 200000
+#define BENCH_MIN_ITERATIONS 3
+#define SYSTICK_MASK 0xffffff
+#define BATCH_FRAMES 16  // the widest lane count, so every lane is busy
+
+static uint8_t samples[NSAMP];
+static kiss_fft_scalar fft_in[NSAMP];
+static kiss_fft_cpx fft_out[NSAMP / 2 + 1];
+static frequency_bin_t bins_7[7];
+static frequency_bin_t bins_500[500];
+static frequency_bin_fixed_t bins_fixed_500[500];
+static fft_bin_bank_t bank_7, bank_500;
+static uint32_t bank_7_mem[(FFT_BIN_BANK_MEM_SIZE(7) + 3) / 4];
+static uint32_t bank_500_mem[(FFT_BIN_BANK_MEM_SIZE(500) + 3) / 4];
+static fft_goertzel_bank_t goertzel;
+static fft_goertzel_bank_t goertzel_1;
+static fft_peak_t peak;
+static volatile float sink;
+
+// kiss_fftr at a size other than NSAMP
+static fft_plan_t plan;
+static kiss_fft_scalar *plan_in;
+static kiss_fft_cpx *plan_out;
+
+// Frames for fft_process_batch and the scalar loop it replaces
+static uint8_t *batch_frames;
+static kiss_fft_cpx *batch_spectra;
+
+#if PICO_ON_DEVICE
+static uint32_t cycles_per_us;
+static uint32_t call_overhead;
+#endif
+
+static void setup();
+static double bench(const char *name, void (*fn)());
+static void bench_kiss_fftr(int nfft);
+static void bench_batch();
+#if PICO_ON_DEVICE
+static void run_nothing();
+#endif
+static void run_kiss_fftr();
+static void run_kernel_fftr();
+static void run_fill_rect();
+static void run_fill_hann();
+static void run_bins_7();
+static void run_bins_500();
+static void run_bank_7();
+static void run_bank_500();
+static void run_process_bank_7();
+static void run_process_power_500();
+static void run_spectrum_frames();
+static void run_process_batch();
+static void run_process_q15_500();
+static void run_process_q31_500();
+static void run_peak_parabolic();
+static void run_peak_jacobsen();
+static void run_peak_quinn();
+static void run_goertzel_fixed();
+static void run_goertzel_float();
+static void run_goertzel_fixed_1();
+static void run_goertzel_float_1();
+static void run_pitch();
+static void run_oled_glyph();
+static void run_oled_show();
+
+int main() {
+  setup();
+  printf("# fft_bench %s nsamp=%d fsamp=%d goertzel_filters=%d\n", BENCH_PLATFORM, NSAMP, FSAMP, goertzel.count);
+  printf("benchmark,iterations,ns_per_frame,frames_per_s,cycles_per_frame\n");
+
+  bench_kiss_fftr(NSAMP);
+  bench_kiss_fftr(1024);
+  bench_kiss_fftr(4096);
+  bench_kiss_fftr(8192);
+  bench("fft_kernel_fftr", run_kernel_fftr);
+  bench("fill_fft_input_rect", run_fill_rect);
+  bench("fill_fft_input_hann", run_fill_hann);
+  bench("compute_bin_amplitudes_7", run_bins_7);
+  bench("compute_bin_amplitudes_500", run_bins_500);
+  bench("bin_bank_7", run_bank_7);
+  bench("bin_bank_500", run_bank_500);
+  double fft_ns = bench("fft_process_bank_7", run_process_bank_7);
+  bench("fft_process_power_500", run_process_power_500);
+  bench("fft_process_q15_500", run_process_q15_500);
+  bench("fft_process_q31_500", run_process_q31_500);
+  bench_batch();
+  bench("fft_find_peak_parabolic", run_peak_parabolic);
+  bench("fft_find_peak_jacobsen", run_peak_jacobsen);
+  bench("fft_find_peak_quinn", run_peak_quinn);
+  bench("goertzel_fixed", run_goertzel_fixed);
+  bench("goertzel_float", run_goertzel_float);
+  double fixed_ns = bench("goertzel_fixed_1", run_goertzel_fixed_1);
+  double float_ns = bench("goertzel_float_1", run_goertzel_float_1);
+  bench("fft_pitch_detect", run_pitch);
+  bench("oled_draw_char", run_oled_glyph);
+  bench("oled_show", run_oled_show);
+  printf("# goertzel break-even against fft_process_bank_7: %.1f fixed filters, %.1f float filters\n", fft_ns / fixed_ns,
+         fft_ns / float_ns);
+
+  fflush(stdout);
+#if PICO_ON_DEVICE
+  while (true) {
+    tight_loop_contents();
+  }
+#endif
+  return 0;
+}
+
+// A plucked A string with some noise, the same every run
+static void setup() {
+  static const int edges[8] = {60, 100, 130, 170, 220, 280, 400, 1000};
+  uint32_t seed = 1;
+
+  fft_setup();
+  for (int i = 0; i < NSAMP; i++) {
+    float t = (float)i / FSAMP;
+    float pluck = 60 * sinf(2 * (float)M_PI * 110 * t) + 25 * sinf(2 * (float)M_PI * 220 * t) +
+                  12 * sinf(2 * (float)M_PI * 330 * t);
+    seed = seed * 1664525 + 1013904223;
+    samples[i] = (uint8_t)(128 + pluck * expf(-2 * t) + (int)(seed >> 29) - 4);
+  }
+
+  for (int j = 0; j < 7; j++) {
+    bins_7[j].name = "band";
+    bins_7[j].freq_min = edges[j];
+    bins_7[j].freq_max = edges[j + 1];
+  }
+  for (int j = 0; j < 500; j++) {
+    bins_500[j].name = "bin";
+    bins_500[j].freq_min = j * FSAMP / NSAMP;
+    bins_500[j].freq_max = (j + 1) * FSAMP / NSAMP;
+    bins_fixed_500[j].name = "bin";
+    bins_fixed_500[j].freq_min = bins_500[j].freq_min;
+    bins_fixed_500[j].freq_max = bins_500[j].freq_max;
+  }
+  size_t len_7 = sizeof(bank_7_mem), len_500 = sizeof(bank_500_mem);
+  fft_bin_bank_init(&bank_7, bins_7, 7, bank_7_mem, &len_7);
+  fft_bin_bank_init(&bank_500, bins_500, 500, bank_500_mem, &len_500);
+
+  // The tuner's Goertzel layout: 7 filters 20 cents apart plus the second harmonic, per string
+  static const float strings[6] = {82.41f, 110.00f, 146.83f, 196.00f, 246.94f, 329.63f};
+  fft_goertzel_init(&goertzel);
+  for (int i = 0; i < 6; i++) {
+    fft_goertzel_add(&goertzel, strings[i], 20, 3);
+    fft_goertzel_add(&goertzel, 2 * strings[i], 0, 0);
+  }
+  // One filter, for the cost per target
+  fft_goertzel_init(&goertzel_1);
+  fft_goertzel_add(&goertzel_1, strings[1], 0, 0);
+
+  fft_process_spectrum(samples, fft_out);
+
+  i2c_init(i2c0, 400 * 1000);
+  gpio_set_function(16, GPIO_FUNC_I2C);
+  gpio_set_function(17, GPIO_FUNC_I2C);
+  gpio_pull_up(16);
+  gpio_pull_up(17);
+  oled_init();
+
+#if PICO_ON_DEVICE
+  while (!stdio_usb_connected()) {
+    sleep_ms(100);
+  }
+  cycles_per_us = clock_get_hz(clk_sys) / 1000000;
+  systick_hw->rvr = SYSTICK_MASK;
+  systick_hw->cvr = 0;
+  systick_hw->csr = 0x5;  // enabled, counting processor clock cycles
+  uint32_t s0 = systick_hw->cvr;
+  run_nothing();
+  call_overhead = (s0 - systick_hw->cvr) & SYSTICK_MASK;
+#endif
+}
+
+// Prints one CSV line and returns the time per call in ns
+static double bench(const char *name, void (*fn)()) {
+  uint32_t iterations = 0;
+  uint32_t batch = 1;
+  uint64_t cycles = 0;
+
+  fn();  // warm up caches and anything created on first use
+
+#if !PICO_ON_DEVICE
+  // Batches of at least a millisecond keep the clock reads out of short benchmarks
+  for (uint64_t t0 = time_us_64(); batch < (1u << 20); batch *= 2, t0 = time_us_64()) {
+    for (uint32_t i = 0; i < batch; i++) {
+      fn();
+    }
+    if (time_us_64() - t0 >= 1000) {
+      break;
+    }
+  }
+#endif
+
+  uint64_t start = time_us_64();
+  uint64_t elapsed;
+  do {
+#if PICO_ON_DEVICE
+    uint32_t t0 = time_us_32();
+    uint32_t s0 = systick_hw->cvr;
+    fn();
+    uint32_t s1 = systick_hw->cvr;
+    uint32_t us = time_us_32() - t0;
+    if ((uint64_t)us * cycles_per_us < SYSTICK_MASK / 2) {
+      cycles += ((s0 - s1) & SYSTICK_MASK) - call_overhead;
+    } else {
+      cycles += (uint64_t)us * cycles_per_us;
+    }
+#else
+    for (uint32_t i = 0; i < batch; i++) {
+      fn();
+    }
+#endif
+    iterations += batch;
+    elapsed = time_us_64() - start;
+  } while (elapsed < BENCH_MIN_US || iterations < BENCH_MIN_ITERATIONS);
+
+  double ns = elapsed * 1000.0 / iterations;
+  printf("%s,%u,%.1f,%.1f,", name, iterations, ns, 1e9 / ns);
+  if (cycles) {
+    printf("%llu", (unsigned long long)(cycles / iterations));
+  }
+  printf("\n");
+  fflush(stdout);
+  return ns;
+}
+
+static void bench_kiss_fftr(int nfft) {
+  char name[32];
+  size_t lenmem = FFT_PLAN_MEM_SIZE(nfft);
+  void *mem = malloc(lenmem);
+
+  snprintf(name, sizeof(name), "kiss_fftr_%d", nfft);
+  plan_in = malloc(sizeof(kiss_fft_scalar) * nfft);
+  plan_out = malloc(sizeof(kiss_fft_cpx) * (nfft / 2 + 1));
+  if (mem && plan_in && plan_out && fft_plan_create(&plan, nfft, false, mem, &lenmem)) {
+    for (int i = 0; i < nfft; i++) {
+      plan_in[i] = samples[i % NSAMP] - 128;
+    }
+    bench(name, run_kiss_fftr);
+  } else {
+    printf("%s,0,,,\n", name);
+  }
+  free(plan_out);
+  free(plan_in);
+  free(mem);
+}
+
+// BATCH_FRAMES frames per call, through fft_process_spectrum one by one and through fft_process_batch
+static void bench_batch() {
+  batch_frames = malloc(NSAMP * BATCH_FRAMES);
+  batch_spectra = malloc(sizeof(kiss_fft_cpx) * (NSAMP / 2 + 1) * BATCH_FRAMES);
+  if (batch_frames && batch_spectra) {
+    for (int f = 0; f < BATCH_FRAMES; f++) {
+      memcpy(batch_frames + f * NSAMP, samples, NSAMP);
+    }
+    bench("fft_process_spectrum_16", run_spectrum_frames);
+    bench("fft_process_batch_16", run_process_batch);
+  } else {
+    printf("fft_process_spectrum_16,0,,,\nfft_process_batch_16,0,,,\n");
+  }
+  free(batch_spectra);
+  free(batch_frames);
+}
+
+#if PICO_ON_DEVICE
+// Measures the cost of a call and the SysTick reads around it
+static void run_nothing() {
+}
+#endif
+
+static void run_kiss_fftr() {
+  kiss_fftr(plan.cfg, plan_in, plan_out);
+}
+
+static void run_kernel_fftr() {
+  fft_kernel_fftr(fft_in, fft_out);
+}
+
+static void run_fill_rect() {
+  fft_set_window(FFT_WINDOW_RECT);
+  sink = fft_stage_fill_input(samples, fft_in);
+}
+
+static void run_fill_hann() {
+  fft_set_window(FFT_WINDOW_HANN);
+  sink = fft_stage_fill_input(samples, fft_in);
+  fft_set_window(FFT_WINDOW_RECT);
+}
+
+static void run_bins_7() {
+  fft_stage_bin_amplitudes(fft_out, bins_7, 7, FFT_SCALE_POWER);
+}
+
+static void run_bins_500() {
+  fft_stage_bin_amplitudes(fft_out, bins_500, 500, FFT_SCALE_POWER);
+}
+
+static void run_bank_7() {
+  fft_bin_bank_accumulate_scaled(&bank_7, fft_out, FFT_SCALE_POWER);
+}
+
+static void run_bank_500() {
+  fft_bin_bank_accumulate_scaled(&bank_500, fft_out, FFT_SCALE_POWER);
+}
+
+// The FFT path a Goertzel bank stands in for: window, FFT and a few bins
+static void run_process_bank_7() {
+  fft_process_bank(samples, &bank_7);
+}
+
+static void run_process_power_500() {
+  fft_process_scaled(samples, bins_500, 500, FFT_SCALE_POWER);
+}
+
+static void run_process_q15_500() {
+  fft_process_q15(samples, bins_fixed_500, 500);
+}
+
+static void run_process_q31_500() {
+  fft_process_q31(samples, bins_fixed_500, 500);
+}
+
+static void run_spectrum_frames() {
+  for (int f = 0; f < BATCH_FRAMES; f++) {
+    fft_process_spectrum(batch_frames + f * NSAMP, batch_spectra + f * (NSAMP / 2 + 1));
+  }
+}
+
+static void run_process_batch() {
+  fft_process_batch(batch_frames, BATCH_FRAMES, batch_spectra);
+}
+
+static void run_peak_parabolic() {
+  fft_find_peak(fft_out, 15, 250, FFT_PEAK_PARABOLIC, &peak);
+}
+
+static void run_peak_jacobsen() {
+  fft_find_peak(fft_out, 15, 250, FFT_PEAK_JACOBSEN, &peak);
+}
+
+static void run_peak_quinn() {
+  fft_find_peak(fft_out, 15, 250, FFT_PEAK_QUINN, &peak);
+}
+
+static void run_goertzel_fixed() {
+  fft_goertzel_process_fixed(&goertzel, samples, NSAMP);
+}
+
+static void run_goertzel_float() {
+  fft_goertzel_process(&goertzel, samples, NSAMP);
+}
+
+static void run_goertzel_fixed_1() {
+  fft_goertzel_process_fixed(&goertzel_1, samples, NSAMP);
+}
+
+static void run_goertzel_float_1() {
+  fft_goertzel_process(&goertzel_1, samples, NSAMP);
+}
+
+static void run_pitch() {
+  fft_pitch_t pitch;
+  fft_pitch_detect(samples + NSAMP - FFT_PITCH_NSAMP, &pitch);
+  sink = pitch.frequency;
+}
+
+// Alternates two glyphs so that every present has changes to send
+static void run_oled_glyph() {
+  static bool toggle;
+
+  toggle = !toggle;
+  draw_char(48, 0, toggle ? A_bitmap : E_bitmap);
+  oled_present();
+}
+
+static void run_oled_show() {
+  oled_show();
+}
@@ -4,32 +4,63 @@
 #include "hardware/timer.h"
 #include <stdio.h>
 #include "fft.h"
+#include "fft_pitch.h"
+#include "fft_goertzel.h"
+#include "fft_wire.h"
 #include "_kiss_fft_guts.h"
 #include "kiss_fft.h"
 #include "kiss_fftr.h"
 #include <stdint.h>
 #include "hardware/i2c.h"
+#include "pico/multicore.h"
+#include "oled.h"
 
-#define OLED_ADDR 0x3C
 #define buffer_size FSAMP
 #define BIN_COUNT 500
-#define OLED_WIDTH 128
-#define OLED_HEIGHT 32
-#define OLED_PAGES (OLED_HEIGHT / 8)
+
+// 1: core1 captures and analyses while core0 only prints and draws
+#ifndef TUNER_PIPELINE
+#define TUNER_PIPELINE 1
+#endif
+#define RESULT_SLOTS 4
+
+// 1: send samples, spectra and pitch as fft_wire frames over USB instead of text
+#ifndef TUNER_STREAM
+#define TUNER_STREAM 0
+#endif
+
+// How the played frequency is found
+#define TUNER_ENGINE_SPECTRUM 0   // strongest FFT bins plus octave heuristics
+#define TUNER_ENGINE_PITCH 1      // McLeod pitch method on the latest FFT_PITCH_NSAMP samples
+#define TUNER_ENGINE_GOERTZEL 2   // fixed-point Goertzel filters around each open string only
+#ifndef TUNER_ENGINE
+#define TUNER_ENGINE TUNER_ENGINE_PITCH
+#endif
+#define MIN_CLARITY 0.8f
+#define GOERTZEL_CENTS 20         // spacing of the filters around each string
+#define GOERTZEL_NEIGHBOURS 3     // filters either side, covers +-60 cents
+
+// With FFT_PROFILE set, how often the stage timings are printed
+#define PROFILE_PERIOD_MS 5000
 
 
 uint8_t buffer[buffer_size]; 
 int start_index = 0;
 
 frequency_bin_t bins[BIN_COUNT];
+fft_bin_bank_t bank;
+uint32_t bank_mem[(FFT_BIN_BANK_MEM_SIZE(BIN_COUNT) + 3) / 4];
 
 void make_bins(){
     for(int q=0;q<(BIN_COUNT-1);q++){
         bins[q].name = "bin";
-        bins[q].freq_min = q;
-        bins[q].freq_max = q+1;   // 1 Hz width
+        bins[q].freq_min = q * FSAMP / NSAMP;
+        bins[q].freq_max = (q+1) * FSAMP / NSAMP;   // one FFT output per bin
         bins[q].amplitude = 0;
     }
+
+    size_t lenmem = sizeof(bank_mem);
+    fft_bin_bank_init(&bank, bins, BIN_COUNT, bank_mem, &lenmem);
 }
 
 
@@ -44,9 +75,9 @@ int highest_bin_amplitude_index()
         if ((q >= 38 && q <= 44) || (q >= 96 && q <= 102))
             continue;
 
-        if (bins[q].amplitude > highest_amplitude)
+        if (bank.amplitude[q] > highest_amplitude)
         {
-            highest_amplitude = bins[q].amplitude;
+            highest_amplitude = bank.amplitude[q];
             index = q;
         }
     }
@@ -70,7 +101,7 @@ int second_highest_bin_amplitude_index(int highest_index)
         if (q >= highest_index - 5 && q <= highest_index + 5)
             continue;
 
-        float A = bins[q].amplitude;
+        float A = bank.amplitude[q];
 
         if (A > amp2)
         {
@@ -83,336 +114,6 @@ int second_highest_bin_amplitude_index(int highest_index)
 }
 
 
-void print_all_bins(){
-    for(int q=0;q<(BIN_COUNT-1);q++){
-        printf("Bin %d: Freq %d-%d Hz, Amplitude: %f\n", q, bins[q].freq_min, bins[q].freq_max, bins[q].amplitude);
-    }
-}
-
-// ------------------- Basic OLED commands -------------------
-static void oled_cmd(i2c_inst_t *i2c, uint8_t cmd) {
-    uint8_t data[2] = {0x00, cmd};
-    i2c_write_blocking(i2c, OLED_ADDR, data, 2, false);
-}
-
-void oled_init() {
-    const uint8_t init_sequence[] = {
-        0xAE,             // display off
-        0x20, 0x00,       // memory addressing mode 0=horizontal
-        0xB0,             // set page start address
-        0xC8,             // COM scan direction
-        0x00, 0x10,       // column address
-        0x40,             // start line
-        0x81, 0x7F,       // contrast
-        0xA1,             // segment remap
-        0xA6,             // normal display
-        0xA8, 0x1F,       // multiplex 32
-        0xA4,             // display all on resume
-        0xD3, 0x00,       // display offset
-        0xD5, 0xF0,       // display clock
-        0xD9, 0x22,       // pre-charge
-        0xDA, 0x02,       // COM pins
-        0xDB, 0x20,       // vcom detect
-        0x8D, 0x14,       // charge pump
-        0xAF              // display on
-    };
-
-    uint8_t buf[2];
-    for (int i = 0; i < sizeof(init_sequence); i++) {
-        buf[0] = 0x00;  // command
-        buf[1] = init_sequence[i];
-        i2c_write_blocking(i2c0, OLED_ADDR, buf, 2, false);
-    }
-}
-
-uint8_t display_buffer[128 * 4]; // 128x32 / 8 = 4 pages
-
-void oled_draw_pixel(int x, int y, bool on) {
-    if (x < 0 || x >= 128 || y < 0 || y >= 32) return;
-    int page = y / 8;
-    int bit = y % 8;
-    if (on)
-        display_buffer[x + page * 128] |= (1 << bit);
-    else
-        display_buffer[x + page * 128] &= ~(1 << bit);
-}
-
-void oled_show() {
-    uint8_t buf[129];
-    buf[0] = 0x40; // data prefix
-    for (int page = 0; page < 4; page++) {
-        // set page address
-        uint8_t cmd[3] = {0x00, 0xB0 | page, 0x00};
-        i2c_write_blocking(i2c0, OLED_ADDR, cmd, 3, false);
-
-        for (int col = 0; col < 128; col += 128) {
-            memcpy(buf + 1, &display_buffer[page * 128], 128);
-            i2c_write_blocking(i2c0, OLED_ADDR, buf, 129, false);
-        }
-    }
-}
-
-const uint32_t A_bitmap[32] = {
-    0b00000000001111111100000000000000,
-    0b00000000011111111110000000000000,
-    0b00000000111111111111000000000000,
-    0b00000001111100011111100000000000,
-    0b00000011111000001111110000000000,
-    0b00000111110000000111111000000000,
-    0b00001111100000000011111100000000,
-    0b00011111000000000001111110000000,
-    0b00111110000000000000111111000000,
-    0b01111100000000000000011111100000,
-    0b11111000000000000000001111110000,
-    0b11111111111111111111111111110000,
-    0b11111111111111111111111111110000,
-    0b11111000000000000000000011110000,
-    0b11111000000000000000000011110000,
-    0b11111000000000000000000011110000,
-    0b11111000000000000000000011110000,
-    0b11111000000000000000000011110000,
-    0b11111000000000000000000011110000,
-    0b11111000000000000000000011110000,
-    0b11111000000000000000000011110000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000
-};
-
-const uint32_t E_bitmap[32] = {
-    0b11111111111111111111111111110000,
-    0b11111111111111111111111111110000,
-    0b11110000000000000000000000000000,
-    0b11110000000000000000000000000000,
-    0b11110000000000000000000000000000,
-    0b11110000000000000000000000000000,
-    0b11110000000000000000000000000000,
-    0b11110000000000000000000000000000,
-    0b11110000000000000000000000000000,
-    0b11110000000000000000000000000000,
-    0b11111111111111111111111111110000,
-    0b11111111111111111111111111110000,
-    0b11110000000000000000000000000000,
-    0b11110000000000000000000000000000,
-    0b11110000000000000000000000000000,
-    0b11110000000000000000000000000000,
-    0b11110000000000000000000000000000,
-    0b11110000000000000000000000000000,
-    0b11110000000000000000000000000000,
-    0b11111111111111111111111111110000,
-    0b11111111111111111111111111110000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000
-};
-
-const uint32_t D_bitmap[32] = {
-    0b11111111111111111111111100000000,
-    0b11111111111111111111111100000000,
-    0b11110000000000000000111111110000,
-    0b11110000000000000000111111110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000111111110000,
-    0b11110000000000000000111111110000,
-    0b11111111111111111111111100000000,
-    0b11111111111111111111111100000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000
-};
-
-const uint32_t B_bitmap[32] = {
-    0b11111111111111111111111111100000,
-    0b11111111111111111111111111100000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11111111111111111111111111100000,
-    0b11111111111111111111111111100000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11110000000000000000000011110000,
-    0b11111111111111111111111111100000,
-    0b11111111111111111111111111100000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000
-};
-
-const uint32_t G_bitmap[32] = {
-    0b00000111111111111111111000000000,
-    0b00011111111111111111111110000000,
-    0b00111100000000000000011111000000,
-    0b01111000000000000000001111100000,
-    0b11110000000000000000000111110000,
-    0b11100000000000000000000011110000,
-    0b11100000000000000000000000000000,
-    0b11100000000000000000000000000000,
-    0b11100000000000000000000000000000,
-    0b11100000000000011111111111100000,
-    0b11100000000000111111111111100000,
-    0b11100000000000111111111111100000,
-    0b11100000000000000000000111110000,
-    0b11100000000000000000000011110000,
-    0b11100000000000000000000011110000,
-    0b11100000000000000000000011110000,
-    0b11100000000000000000000011110000,
-    0b11110000000000000000000111110000,
-    0b01111000000000000000001111100000,
-    0b00111100000000000000011111000000,
-    0b00011111111111111111111110000000,
-    0b00000111111111111111111000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000
-};
-
-const uint32_t Z_bitmap[32] = {
-    0b11111111111111111111111111110000,
-    0b11111111111111111111111111110000,
-    0b00000000000000000000000011110000,
-    0b00000000000000000000001111000000,
-    0b00000000000000000000111100000000,
-    0b00000000000000000011110000000000,
-    0b00000000000000000111100000000000,
-    0b00000000000000001111000000000000,
-    0b00000000000000011110000000000000,
-    0b00000000000000111100000000000000,
-    0b00000000000001111000000000000000,
-    0b00000000000011110000000000000000,
-    0b00000000000111100000000000000000,
-    0b00000000001111000000000000000000,
-    0b00000000011110000000000000000000,
-    0b00000000111100000000000000000000,
-    0b00000001111000000000000000000000,
-    0b00000011110000000000000000000000,
-    0b00000111100000000000000000000000,
-    0b00001111000000000000000000000000,
-    0b00111100000000000000000000000000,
-    0b11111111111111111111111111110000,
-    0b11111111111111111111111111110000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000
-};
-
-const uint32_t Rect_bitmap[32] = {
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-
-    0b00000000000011111111000000000000,
-    0b00000000000011111111000000000000,
-    0b00000000000011111111000000000000,
-    0b00000000000011111111000000000000,
-    0b00000000000011111111000000000000,
-    0b00000000000011111111000000000000,
-    0b00000000000011111111000000000000,
-    0b00000000000011111111000000000000,
-    0b00000000000011111111000000000000,
-    0b00000000000011111111000000000000,
-    0b00000000000011111111000000000000,
-
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000,
-    0b00000000000000000000000000000000
-};
-
-
-void oled_clear() {
-    memset(display_buffer, 0, sizeof(display_buffer)); // clear buffer
-    oled_show();  // send buffer to OLED
-}
-
-void draw_char(int x0, int y0, const uint32_t bitmap[32]) {
-    for (int y = 0; y < 32; y++) {
-        for (int x = 0; x < 32; x++) {
-            bool pixel_on = (bitmap[y] >> (31 - x)) & 1;
-            oled_draw_pixel(x0 + x, y0 + y, pixel_on);
-        }
-    }
-    oled_show();
-}
-
 typedef struct {
     const char name;
     float freq;
@@ -471,8 +172,211 @@ int distance_from_closest_note(float frequency, char closestString) {
 
 
 
+#if TUNER_ENGINE == TUNER_ENGINE_GOERTZEL
+fft_goertzel_bank_t goertzel;
+int goertzel_fundamental[6];
+int goertzel_harmonic[6];
+
+void make_goertzel_targets(){
+    fft_goertzel_init(&goertzel);
+    for (int i = 0; i < 6; i++) {
+        int centre = fft_goertzel_add(&goertzel, strings[i].freq, GOERTZEL_CENTS, GOERTZEL_NEIGHBOURS);
+        goertzel_fundamental[i] = centre - GOERTZEL_NEIGHBOURS;
+        goertzel_harmonic[i] = fft_goertzel_add(&goertzel, 2 * strings[i].freq, 0, 0);
+    }
+}
+#endif
+
+typedef struct {
+    int index;
+    int index2;
+    float amplitude;
+    float freq;
+    float clarity;
+} tuner_result_t;
+
+void analyze_frame(uint8_t *samples, tuner_result_t *result) {
+#if TUNER_ENGINE == TUNER_ENGINE_PITCH
+    fft_pitch_t pitch;
+
+    FFT_PROFILE_BEGIN(FFT_STAGE_DETECT);
+    fft_pitch_detect(samples + NSAMP - FFT_PITCH_NSAMP, &pitch);
+    FFT_PROFILE_END(FFT_STAGE_DETECT);
+    result->index = -1;
+    result->index2 = -1;
+    result->amplitude = 0;
+    result->freq = pitch.frequency;
+    result->clarity = pitch.clarity;
+#elif TUNER_ENGINE == TUNER_ENGINE_GOERTZEL
+    const int group = 2 * GOERTZEL_NEIGHBOURS + 1;
+    int best = 0;
+    float best_score = -1.0f;
+
+    FFT_PROFILE_BEGIN(FFT_STAGE_DETECT);
+    fft_goertzel_process_fixed(&goertzel, samples, NSAMP);
+    // The second harmonic keeps a loud low string from losing to the string an octave up
+    for (int i = 0; i < 6; i++) {
+        int peak = fft_goertzel_peak(&goertzel, goertzel_fundamental[i], group);
+        float score = goertzel.power[peak] + goertzel.power[goertzel_harmonic[i]];
+        if (score > best_score) {
+            best_score = score;
+            best = i;
+        }
+    }
+    int peak = fft_goertzel_peak(&goertzel, goertzel_fundamental[best], group);
+    result->index = -1;
+    result->index2 = -1;
+    result->amplitude = sqrtf(goertzel.power[peak]);
+    result->freq = fft_goertzel_refine(&goertzel, peak, goertzel_fundamental[best], group);
+    FFT_PROFILE_END(FFT_STAGE_DETECT);
+    result->clarity = 1.0f;
+#else
+    kiss_fft_cpx spectrum[NSAMP / 2 + 1];
+
+    fft_process_spectrum(samples, spectrum);
+    fft_bin_bank_accumulate_scaled(&bank, spectrum, FFT_SCALE_POWER);  // the peak search only needs ordering
+    FFT_PROFILE_BEGIN(FFT_STAGE_DETECT);
+    int index = highest_bin_amplitude_index();
+    if (index < 0) {
+        // Silence: no bin above zero, so nothing to refine or index
+        FFT_PROFILE_END(FFT_STAGE_DETECT);
+        result->index = -1;
+        result->index2 = -1;
+        result->amplitude = 0;
+        result->freq = 0;
+        result->clarity = 0;
+        return;
+    }
+    int index2 = second_highest_bin_amplitude_index(index);
+    float offset = fft_refine_peak(spectrum, index, FFT_PEAK_QUINN);
+    float freq = (index + offset) * FFT_BIN_HZ;
+    // Between 200 and 436 Hz a dominant peak above the runner-up is usually the third harmonic
+    if (index >= 50 && index < 109 && index > index2){
+        freq /= 3.0f;
+    }
+    FFT_PROFILE_END(FFT_STAGE_DETECT);
+    result->index = index;
+    result->index2 = index2;
+    result->amplitude = sqrtf(bank.amplitude[index]);
+    result->freq = freq;
+    result->clarity = 1.0f;
+#endif
+}
+
+void show_result(const tuner_result_t *result) {
+    float freq = result->freq;
+    if (freq <= 0 || result->clarity < MIN_CLARITY) {
+        return;  // nothing periodic enough to tune to, keep the last reading
+    }
+    char closestString = closestGuitarString(freq);
+#if !TUNER_STREAM
+    FFT_PROFILE_BEGIN(FFT_STAGE_PRINT);
+    printf("-----------------------------------------------------------------------\n");
+    if (result->index >= 0) {
+        printf("Second Dominant Frequency: %.0f Hz with Amplitude: \n", fft_bin_frequency(result->index2));
+        printf("Dominant Frequency: %.0f Hz with Amplitude: %f\n", fft_bin_frequency(result->index), result->amplitude);
+    }
+    printf("Estimated Frequency: %f Hz (clarity %.2f)\n", freq, result->clarity);
+    printf("Closest Guitar String: %c\n", closestString);
+    printf("-----------------------------------------------------------------------\n");
+    FFT_PROFILE_END(FFT_STAGE_PRINT);
+#endif
+    FFT_PROFILE_BEGIN(FFT_STAGE_DISPLAY);
+    oled_clear();
+    switch (closestString) {
+        case 'E':
+            draw_char(48, 0, E_bitmap);
+            break;
+        case 'A':
+            draw_char(48, 0, A_bitmap);
+            break;
+        case 'D':
+            draw_char(48, 0, D_bitmap);
+            break;
+        case 'G':
+            draw_char(48, 0, G_bitmap);
+            break;
+        case 'B':
+            draw_char(48, 0, B_bitmap);
+            break;
+        case 'e':
+            draw_char(48, 0, E_bitmap);
+        default:
+            oled_clear();
+            break;
+    }
+
+    int distance = distance_from_closest_note(freq, closestString);
+    if (distance == 2) {
+        draw_char(16, 0, Rect_bitmap);
+    } else if (distance == 1) {
+        draw_char(80, 0, Rect_bitmap);
+    }
+    oled_present();
+    FFT_PROFILE_END(FFT_STAGE_DISPLAY);
+}
+
+#if TUNER_STREAM
+fft_wire_encoder_t wire;
+
+void wire_write(const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        putchar_raw(data[i]);
+    }
+}
+
+// Replaces printing every bin as text; decode on the host with tools/fft_wire_dump
+void stream_frame(const uint8_t *samples, const tuner_result_t *result) {
+    FFT_PROFILE_BEGIN(FFT_STAGE_STREAM);
+    fft_wire_send_samples(&wire, samples, NSAMP, FSAMP, time_us_32());
+#if TUNER_ENGINE == TUNER_ENGINE_SPECTRUM
+    fft_wire_send_spectrum_f32(&wire, bank.amplitude, BIN_COUNT - 1, 0, FFT_BIN_HZ);
+#endif
+    fft_wire_send_pitch(&wire, result->freq, result->clarity,
+                        TUNER_ENGINE == TUNER_ENGINE_PITCH      ? FFT_WIRE_PITCH_MPM
+                        : TUNER_ENGINE == TUNER_ENGINE_GOERTZEL ? FFT_WIRE_PITCH_GOERTZEL
+                                                                : FFT_WIRE_PITCH_SPECTRUM);
+    FFT_PROFILE_END(FFT_STAGE_STREAM);
+}
+#endif
+
+#if TUNER_PIPELINE
+// Core1 owns capture and analysis and hands results to core0 through the ring
+uint8_t capture_bufs[2][NSAMP];
+tuner_result_t result_slots[RESULT_SLOTS];
+fft_ring_t results;
+
+void core1_main() {
+    fft_capture_start(capture_bufs[0], capture_bufs[1], NSAMP);
+
+    while (true) {
+        uint8_t *samples = fft_capture_acquire();
+        if (!samples) {
+            tight_loop_contents();
+            continue;
+        }
+
+        // When core0 falls behind the frame is skipped rather than queued
+        tuner_result_t *result = fft_ring_claim(&results);
+        if (result) {
+            FFT_PROFILE_BEGIN(FFT_STAGE_FRAME);
+            analyze_frame(samples, result);
+#if TUNER_STREAM
+            stream_frame(samples, result);
+#endif
+            FFT_PROFILE_END(FFT_STAGE_FRAME);
+            fft_ring_publish(&results);
+        }
+        fft_capture_release(samples);
+    }
+}
+#endif
+
 int main() {
     
+#if FFT_PROFILE
+    fft_profile_init();
+#endif
     fft_setup();
 
     i2c_init(i2c0, 400 * 1000);
@@ -483,79 +387,58 @@ int main() {
 
 
     sleep_ms(3000);
+#if TUNER_STREAM
+    fft_wire_init(&wire, wire_write, true);
+#else
     printf("FFT Setup Complete\n");
+#endif
 
     oled_init();
-    memset(display_buffer, 0, sizeof(display_buffer));
+    oled_clear();
 
     draw_char(32, 0, A_bitmap); // draw A in top-left
     draw_char(64, 0, Z_bitmap); // draw Z in top-right
+    oled_present();
 
     sleep_ms(2000);
 
-    while (true) {
-        fft_sample(buffer);
+    make_bins();
+#if TUNER_ENGINE == TUNER_ENGINE_GOERTZEL
+    make_goertzel_targets();
+#endif
 
-        make_bins();
-        fft_process(buffer, bins, BIN_COUNT);
-        int index = highest_bin_amplitude_index();
-        int index2 = second_highest_bin_amplitude_index(index);
-        float freq = 0; // 1 Hz per bin
-        if (index < 109){
-            if (index < index2){
-                freq = index * 4;
-            } else{
-                freq = index * (4.0f / 3.0f);
-            }
-        } else {
-            freq = index * 4;
-        }
-        if (index < 50.0f){
-            freq = index * 4.0f;
-        }
-        printf("-----------------------------------------------------------------------\n");
-        printf("Second Dominant Frequency: %d Hz with Amplitude: \n", index2);
-        printf("Dominant Frequency: %d Hz with Amplitude: %f\n", index, bins[index].amplitude);
-        printf("Estimated Frequency: %f Hz\n", freq);
-        char closestString = closestGuitarString(freq);
-        printf("Closest Guitar String: %c\n", closestString);
-        printf("-----------------------------------------------------------------------\n");
-        oled_clear();
-        switch (closestString) {
-            case 'E':
-                draw_char(48, 0, E_bitmap);
-                break;
-            case 'A':
-                draw_char(48, 0, A_bitmap);
-                break;
-            case 'D':
-                draw_char(48, 0, D_bitmap);
-                break;
-            case 'G':
-                draw_char(48, 0, G_bitmap);
-                break;
-            case 'B':
-                draw_char(48, 0, B_bitmap);
-                break;
-            case 'e':
-                draw_char(48, 0, E_bitmap);
-            default:
-                oled_clear();
-                break;
-        }
+#if TUNER_PIPELINE
+    fft_ring_init(&results, result_slots, sizeof(tuner_result_t), RESULT_SLOTS);
+    multicore_launch_core1(core1_main);
 
-        int distance = distance_from_closest_note(freq, closestString);
-        if (distance == 2) {
-            draw_char(16, 0, Rect_bitmap);
-        } else if (distance == 1) {
-            draw_char(80, 0, Rect_bitmap);
+    while (true) {
+        tuner_result_t *result = fft_ring_peek(&results);
+        if (!result) {
+            tight_loop_contents();
+            continue;
         }
+        show_result(result);
+        fft_ring_release(&results);
+#if FFT_PROFILE && !TUNER_STREAM
+        fft_profile_print_every(PROFILE_PERIOD_MS);
+#endif
+    }
+#else
+    while (true) {
+        tuner_result_t result;
 
-
-        
-
-
-        
+        FFT_PROFILE_BEGIN(FFT_STAGE_FRAME);
+        fft_sample(buffer);
+        analyze_frame(buffer, &result);
+#if TUNER_STREAM
+        stream_frame(buffer, &result);
+#endif
+        show_result(&result);
+        FFT_PROFILE_END(FFT_STAGE_FRAME);
+#if FFT_PROFILE && !TUNER_STREAM
+        fft_profile_print_every(PROFILE_PERIOD_MS);
+#endif
     }
+#endif
     return 0;
 }
@@ -1,29 +1,59 @@
 import re
+import struct
+import sys
 import matplotlib.pyplot as plt
 import numpy as np
 
 FSAMP = 8000  # ADC sampling rate
 
-# --- Load audio samples ---
-with open("audio_samples.txt", "r") as f:
-    audio_data = f.read()
 
-# Parse the audio samples
-samples = [int(x) for x in re.findall(r"Buffer\[\d+\]: (\d+)", audio_data)]
-samples = np.array(samples)
+def load_recording(path, index):
+    """One frame of a recording made with tools/fft_wire_dump -r (pico/fft_record.h)."""
+    header = np.fromfile(path, dtype=np.uint8, count=40)
+    magic, version, header_size, sample_rate, frame_samples, _, flags, frame_size, _, spectrum_count, _, first_hz, step_hz, _ = \
+        struct.unpack("<4sHHIHBBIIHHffI", header.tobytes())
+    if magic != b"FFTR" or version != 1:
+        sys.exit(f"{path} is not an FFT recording")
 
-# Time axis for waveform
-time = np.arange(len(samples)) / FSAMP
+    records = np.memmap(path, dtype=np.uint8, mode="r", offset=header_size)
+    record = records[index * frame_size:(index + 1) * frame_size]
+    samples = np.array(record[16:16 + frame_samples], dtype=int)
 
-# --- Load FFT data ---
-with open("fft_data.txt", "r") as f:
-    fft_data = f.read()
+    if flags & 1:  # FFT_RECORD_SPECTRUM: the device's bin powers
+        offset = (16 + frame_samples + 3) & ~3
+        power = record[offset:offset + 4 * spectrum_count].view("<f4")
+        freqs = first_hz + step_hz * np.arange(spectrum_count)
+    else:
+        power = np.abs(np.fft.rfft(samples - samples.mean())) ** 2
+        freqs = np.fft.rfftfreq(len(samples), 1 / sample_rate)
+    return sample_rate, samples, list(freqs), list(np.sqrt(power))
 
-pattern = r"Bin (\d+): Freq (\d+)-(\d+) Hz, Amplitude: ([\d\.]+)"
-matches = re.findall(pattern, fft_data)
 
-freqs = [(int(f_start) + int(f_end)) / 2 for _, f_start, f_end, _ in matches]
-amps = [float(amp) for _, _, _, amp in matches]
+if len(sys.argv) > 1:
+    # python graph_fft.py capture.frec [frame]
+    FSAMP, samples, freqs, amps = load_recording(sys.argv[1], int(sys.argv[2]) if len(sys.argv) > 2 else 0)
+    time = np.arange(len(samples)) / FSAMP
+else:
+    # --- Load audio samples ---
+    with open("audio_samples.txt", "r") as f:
+        audio_data = f.read()
+
+    # Parse the audio samples
+    samples = [int(x) for x in re.findall(r"Buffer\[\d+\]: (\d+)", audio_data)]
+    samples = np.array(samples)
+
+    # Time axis for waveform
+    time = np.arange(len(samples)) / FSAMP
+
+    # --- Load FFT data ---
+    with open("fft_data.txt", "r") as f:
+        fft_data = f.read()
+
+    pattern = r"Bin (\d+): Freq (\d+)-(\d+) Hz, Amplitude: ([\d\.]+)"
+    matches = re.findall(pattern, fft_data)
+
+    freqs = [(int(f_start) + int(f_end)) / 2 for _, f_start, f_end, _ in matches]
+    amps = [float(amp) for _, _, _, amp in matches]
 
 # Convert amplitudes to dB
 amps_db = 20 * np.log10(np.array(amps) + 1e-6)
@@ -0,0 +1,451 @@
+#include "pico/stdlib.h"
+#include "pico/fft_config.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/i2c.h"
+#include "pico/fft_capture.h"
+#include "host_hal.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define ADC_CLOCK_HZ 48000000.0f
+#define OLED_I2C_ADDR 0x3C
+
+struct i2c_inst {
+  int index;
+};
+
+static adc_hw_t adc_regs;
+adc_hw_t *adc_hw = &adc_regs;
+
+static struct i2c_inst i2c_insts[2] = {{0}, {1}};
+i2c_inst_t *i2c0 = &i2c_insts[0];
+i2c_inst_t *i2c1 = &i2c_insts[1];
+
+// Input samples in -1..1 at their own rate, read at the ADC rate
+static float *input;
+static size_t input_len;
+static float input_rate;
+static double input_pos;
+static float adc_rate = FSAMP;
+static uint64_t samples_read;
+
+static uint8_t *dma_dest;
+static uint dma_count;
+
+// SSD1306 state
+static uint8_t oled_ram[HOST_OLED_PAGES][HOST_OLED_WIDTH];
+static uint8_t oled_cmd_buf[8];
+static int oled_cmd_len;
+static int oled_mode = 2;  // page addressing after reset
+static int oled_rows = HOST_OLED_PAGES * 8;
+static int oled_col, oled_col_start, oled_col_end = HOST_OLED_WIDTH - 1;
+static int oled_page, oled_page_start, oled_page_end = HOST_OLED_PAGES - 1;
+static host_i2c_stats_t i2c_stats;
+
+// Continuous capture, written by the capture thread or host_capture_advance()
+static pthread_mutex_t capture_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t capture_thread;
+static bool capture_manual;
+static volatile bool capture_running;
+static uint8_t *capture_bufs[2];
+static int capture_count;
+static int capture_index;
+static int capture_pos;
+
+static void load_input();
+static bool load_wav(const uint8_t *data, size_t size);
+static float wav_sample(const uint8_t *p, int format, int bits);
+static uint8_t next_sample();
+static void oled_command_byte(uint8_t byte);
+static int oled_command_length(uint8_t cmd);
+static void oled_run_command(const uint8_t *cmd);
+static void oled_data_byte(uint8_t byte);
+static void finish();
+static bool host_capture_start(uint8_t *buf_a, uint8_t *buf_b, int count);
+static void host_capture_stop(void);
+static uint32_t host_capture_lock(void);
+static void host_capture_unlock(uint32_t state);
+static void *capture_main(void *arg);
+
+static const fft_capture_hal_t host_capture_hal = {
+  .start = host_capture_start,
+  .stop = host_capture_stop,
+  .lock = host_capture_lock,
+  .unlock = host_capture_unlock,
+};
+
+void stdio_init_all(void) {}
+
+int putchar_raw(int c) {
+  return putchar(c);
+}
+
+void sleep_ms(uint32_t ms) {}
+
+void sleep_us(uint64_t us) {}
+
+uint64_t time_us_64(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+uint32_t time_us_32(void) {
+  return (uint32_t)time_us_64();
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {}
+
+void gpio_pull_up(uint gpio) {}
+
+void adc_init(void) {}
+
+void adc_gpio_init(uint gpio) {}
+void adc_select_input(uint input) {}
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift) {}
+
+void adc_set_clkdiv(float clkdiv) {
+  adc_rate = ADC_CLOCK_HZ / clkdiv;
+}
+
+void adc_fifo_drain(void) {}
+void adc_run(bool run) {}
+
+int dma_claim_unused_channel(bool required) {
+  return 0;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+  dma_channel_config c = {0};
+  return c;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) {}
+void channel_config_set_read_increment(dma_channel_config *c, bool incr) {}
+void channel_config_set_write_increment(dma_channel_config *c, bool incr) {}
+void channel_config_set_dreq(dma_channel_config *c, uint dreq) {}
+
+// The only transfer the library sets up is ADC FIFO to memory, served from the input file
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger) {
+  dma_dest = (uint8_t *)write_addr;
+  dma_count = transfer_count;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel) {
+  for (uint i = 0; i < dma_count; i++) {
+    dma_dest[i] = next_sample();
+  }
+  dma_count = 0;
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+  return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+  i2c_stats.transactions++;
+  i2c_stats.bytes += len;
+  if (addr != OLED_I2C_ADDR || len == 0) {
+    return len;
+  }
+  // Control byte: 0x00 commands follow, 0x40 display data follows
+  for (size_t i = 1; i < len; i++) {
+    if (src[0] & 0x40) {
+      oled_data_byte(src[i]);
+    } else {
+      oled_command_byte(src[i]);
+    }
+  }
+  return len;
+}
+
+const uint8_t *host_oled_ram() {
+  return &oled_ram[0][0];
+}
+
+void host_oled_print(FILE *out, int pages) {
+  for (int y = 0; y < pages * 8; y++) {
+    for (int x = 0; x < HOST_OLED_WIDTH; x++) {
+      fputc((oled_ram[y / 8][x] >> (y % 8)) & 1 ? '#' : '.', out);
+    }
+    fputc('\n', out);
+  }
+}
+
+host_i2c_stats_t host_i2c_stats() {
+  return i2c_stats;
+}
+
+uint64_t host_samples_read() {
+  return samples_read;
+}
+
+void host_input_set(const float *samples, size_t len, float rate) {
+  free(input);
+  input = malloc(sizeof(float) * (len ? len : 1));
+  memcpy(input, samples, sizeof(float) * len);
+  input_len = len;
+  input_rate = rate;
+  input_pos = 0;
+}
+
+const fft_capture_hal_t *fft_capture_platform_hal(void) {
+  return &host_capture_hal;
+}
+
+void host_capture_manual(bool manual) {
+  capture_manual = manual;
+}
+
+// The DMA's part: fills the buffers in turn and completes each one with the lock held
+void host_capture_advance(int count) {
+  while (count-- > 0 && capture_running) {
+    capture_bufs[capture_index][capture_pos] = next_sample();
+    if (++capture_pos == capture_count) {
+      pthread_mutex_lock(&capture_mutex);
+      fft_capture_complete(capture_index);
+      pthread_mutex_unlock(&capture_mutex);
+      capture_pos = 0;
+      capture_index ^= 1;
+    }
+  }
+}
+
+static bool host_capture_start(uint8_t *buf_a, uint8_t *buf_b, int count) {
+  capture_bufs[0] = buf_a;
+  capture_bufs[1] = buf_b;
+  capture_count = count;
+  capture_index = 0;
+  capture_pos = 0;
+  capture_running = true;
+  if (!capture_manual && pthread_create(&capture_thread, NULL, capture_main, NULL) != 0) {
+    capture_running = false;
+  }
+  return capture_running;
+}
+
+static void host_capture_stop(void) {
+  bool was_running = capture_running;
+
+  capture_running = false;
+  if (was_running && !capture_manual) {
+    pthread_join(capture_thread, NULL);
+  }
+}
+
+static uint32_t host_capture_lock(void) {
+  pthread_mutex_lock(&capture_mutex);
+  return 0;
+}
+
+static void host_capture_unlock(uint32_t state) {
+  pthread_mutex_unlock(&capture_mutex);
+}
+
+// One buffer per buffer period at the ADC rate, like the chained DMA channels
+static void *capture_main(void *arg) {
+  struct timespec next;
+
+  clock_gettime(CLOCK_MONOTONIC, &next);
+  while (capture_running) {
+    host_capture_advance(capture_count);
+    uint64_t ns = next.tv_nsec + (uint64_t)(capture_count * 1e9 / adc_rate);
+    next.tv_sec += ns / 1000000000;
+    next.tv_nsec = ns % 1000000000;
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+  }
+  return NULL;
+}
+
+static void load_input() {
+  const char *path = getenv("FFT_HOST_INPUT");
+  const char *rate = getenv("FFT_HOST_INPUT_RATE");
+  FILE *f;
+
+  if (input) {
+    return;
+  }
+  atexit(finish);
+  if (!path || !(f = fopen(path, "rb"))) {
+    fprintf(stderr, "Set FFT_HOST_INPUT to a WAV or raw 8-bit file to sample from\n");
+    exit(1);
+  }
+  fseek(f, 0, SEEK_END);
+  size_t size = ftell(f);
+  uint8_t *data = malloc(size);
+  fseek(f, 0, SEEK_SET);
+  size = fread(data, 1, size, f);
+  fclose(f);
+
+  if (size >= 12 && memcmp(data, "RIFF", 4) == 0 && memcmp(data + 8, "WAVE", 4) == 0) {
+    if (!load_wav(data, size)) {
+      fprintf(stderr, "Unsupported WAV file %s\n", path);
+      exit(1);
+    }
+  } else {
+    input_len = size;
+    input_rate = rate ? atof(rate) : FSAMP;
+    input = malloc(sizeof(float) * (size ? size : 1));
+    for (size_t i = 0; i < size; i++) {
+      input[i] = (data[i] - 128) / 128.0f;
+    }
+  }
+  free(data);
+}
+
+static bool load_wav(const uint8_t *data, size_t size) {
+  int format = 0, channels = 0, bits = 0;
+  size_t pos = 12;
+
+  while (pos + 8 <= size) {
+    const uint8_t *chunk = data + pos;
+    size_t len = chunk[4] | (chunk[5] << 8) | (chunk[6] << 16) | ((size_t)chunk[7] << 24);
+    if (len > size - pos - 8) {
+      len = size - pos - 8;
+    }
+    if (memcmp(chunk, "fmt ", 4) == 0 && len >= 16) {
+      format = chunk[8] | (chunk[9] << 8);
+      channels = chunk[10] | (chunk[11] << 8);
+      input_rate = chunk[12] | (chunk[13] << 8) | (chunk[14] << 16) | ((uint32_t)chunk[15] << 24);
+      bits = chunk[22] | (chunk[23] << 8);
+      if (format == 0xfffe && len >= 26) {
+        format = chunk[32] | (chunk[33] << 8);  // WAVE_FORMAT_EXTENSIBLE sub-format
+      }
+    } else if (memcmp(chunk, "data", 4) == 0 && channels > 0) {
+      if (!((format == 1 && (bits == 8 || bits == 16 || bits == 24 || bits == 32)) || (format == 3 && bits == 32))) {
+        return false;
+      }
+      int stride = channels * bits / 8;
+      input_len = len / stride;
+      input = malloc(sizeof(float) * (input_len ? input_len : 1));
+      for (size_t i = 0; i < input_len; i++) {
+        input[i] = wav_sample(chunk + 8 + i * stride, format, bits);
+      }
+      return input_rate > 0;
+    }
+    pos += 8 + len + (len & 1);
+  }
+  return false;
+}
+
+static float wav_sample(const uint8_t *p, int format, int bits) {
+  if (format == 3) {
+    float f;
+    memcpy(&f, p, sizeof(f));
+    return f;
+  }
+  switch (bits) {
+  case 8: return (p[0] - 128) / 128.0f;
+  case 16: return (int16_t)(p[0] | (p[1] << 8)) / 32768.0f;
+  case 24: return (int32_t)((p[0] << 8) | (p[1] << 16) | ((uint32_t)p[2] << 24)) / 2147483648.0f;
+  default: return (int32_t)(p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24)) / 2147483648.0f;
+  }
+}
+
+// One 8-bit ADC reading, linearly interpolated from the input at the ADC rate
+static uint8_t next_sample() {
+  if (!input) {
+    load_input();
+  }
+  size_t i = (size_t)input_pos;
+  if (i + 1 >= input_len) {
+    exit(0);
+  }
+  float frac = input_pos - i;
+  float x = input[i] + (input[i + 1] - input[i]) * frac;
+  int v = lroundf(128.0f + 128.0f * x);
+
+  input_pos += input_rate / adc_rate;
+  samples_read++;
+  return v < 0 ? 0 : v > 255 ? 255 : v;
+}
+
+static void oled_command_byte(uint8_t byte) {
+  oled_cmd_buf[oled_cmd_len++] = byte;
+  if (oled_cmd_len == oled_command_length(oled_cmd_buf[0])) {
+    oled_run_command(oled_cmd_buf);
+    oled_cmd_len = 0;
+  }
+}
+
+static int oled_command_length(uint8_t cmd) {
+  switch (cmd) {
+  case 0x21: case 0x22:
+    return 3;
+  case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+    return 2;
+  default:
+    return 1;
+  }
+}
+
+static void oled_run_command(const uint8_t *cmd) {
+  switch (cmd[0]) {
+  case 0x20:
+    oled_mode = cmd[1] & 3;
+    break;
+  case 0xA8:
+    oled_rows = (cmd[1] & 0x3f) + 1;
+    break;
+  case 0x21:
+    oled_col = oled_col_start = cmd[1] & 0x7f;
+    oled_col_end = cmd[2] & 0x7f;
+    break;
+  case 0x22:
+    oled_page = oled_page_start = cmd[1] & 7;
+    oled_page_end = cmd[2] & 7;
+    break;
+  default:
+    if (cmd[0] <= 0x0f) {
+      oled_col = (oled_col & 0xf0) | cmd[0];
+    } else if (cmd[0] <= 0x1f) {
+      oled_col = (oled_col & 0x0f) | ((cmd[0] & 0x07) << 4);
+    } else if ((cmd[0] & 0xf8) == 0xb0) {
+      oled_page = cmd[0] & 7;
+    }
+    break;
+  }
+}
+
+static void oled_data_byte(uint8_t byte) {
+  oled_ram[oled_page][oled_col] = byte;
+  i2c_stats.data_bytes++;
+  if (oled_mode == 2) {
+    oled_col = (oled_col + 1) & 0x7f;
+  } else if (oled_col++ == oled_col_end) {
+    oled_col = oled_col_start;
+    oled_page = oled_page == oled_page_end ? oled_page_start : oled_page + 1;
+  }
+}
+
+static void finish() {
+  const char *path = getenv("FFT_HOST_OLED");
+
+  fflush(stdout);
+  fprintf(stderr, "%llu samples read, %u I2C transactions, %u bytes (%u display data)\n",
+          (unsigned long long)samples_read, i2c_stats.transactions, i2c_stats.bytes, i2c_stats.data_bytes);
+  if (!path) {
+    return;
+  }
+  if (strcmp(path, "-") == 0) {
+    host_oled_print(stderr, (oled_rows + 7) / 8);
+    return;
+  }
+  FILE *f = fopen(path, "w");
+  if (!f) {
+    fprintf(stderr, "Failed to create %s\n", path);
+    return;
+  }
+  fprintf(f, "P1\n%d %d\n", HOST_OLED_WIDTH, oled_rows);
+  for (int y = 0; y < oled_rows; y++) {
+    for (int x = 0; x < HOST_OLED_WIDTH; x++) {
+      fputc((oled_ram[y / 8][x] >> (y % 8)) & 1 ? '1' : '0', f);
+      fputc(x + 1 < HOST_OLED_WIDTH ? ' ' : '\n', f);
+    }
+  }
+  fclose(f);
+}
@@ -0,0 +1,51 @@
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * What the host stand-in does in place of the hardware, set through the
+ * environment:
+ *
+ *   FFT_HOST_INPUT       WAV file (PCM or float, first channel) or raw 8-bit
+ *                        unsigned samples that fft_sample() reads from. The
+ *                        input is resampled to the ADC rate, FSAMP unless
+ *                        fft_set_sample_rate() changed it. The program exits
+ *                        when it runs out.
+ *   FFT_HOST_INPUT_RATE  sample rate of a raw file, FSAMP by default
+ *   FFT_HOST_OLED        file to write the final SSD1306 image to as a PBM,
+ *                        or - to print it on stderr
+ *
+ * I2C writes to the SSD1306 address are decoded into an in-memory copy of
+ * the display's RAM.
+ *
+ * Continuous capture (fft_capture_platform_hal()) runs a thread that fills
+ * one buffer from the input per buffer period. In manual mode there is no
+ * thread, and host_capture_advance() plays the DMA for a number of samples,
+ * so tests can step through the double buffering.
+ */
+
+#define HOST_OLED_WIDTH 128
+#define HOST_OLED_PAGES 8
+
+typedef struct {
+    uint32_t transactions;
+    uint32_t bytes;       // including control bytes
+    uint32_t data_bytes;  // written to display RAM
+} host_i2c_stats_t;
+
+const uint8_t *host_oled_ram();  // HOST_OLED_PAGES rows of HOST_OLED_WIDTH bytes, LSB on top
+void host_oled_print(FILE *out, int pages);
+host_i2c_stats_t host_i2c_stats();
+uint64_t host_samples_read();
+
+// Input in -1..1 at 'rate' in place of FFT_HOST_INPUT
+void host_input_set(const float *samples, size_t len, float rate);
+// Call before fft_capture_start()
+void host_capture_manual(bool manual);
+void host_capture_advance(int count);
+
+#endif /* HOST_HAL_H */
@@ -0,0 +1,9 @@
+#ifndef HOST_PICO_MULTICORE_H
+#define HOST_PICO_MULTICORE_H
+
+#include "pico/stdlib.h"
+
+// Declared so sources compile; the host build runs single-core (TUNER_PIPELINE=0)
+void multicore_launch_core1(void (*entry)(void));
+
+#endif /* HOST_PICO_MULTICORE_H */
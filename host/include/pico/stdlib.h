@@ -0,0 +1,40 @@
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+/*
+ * Stand-in for the Pico SDK on a Linux host, covering what pico_fft and
+ * blink_any use. Timing calls return the host's monotonic clock and
+ * sleeping is skipped so files are analysed at full speed. See host_hal.h
+ * for where samples come from and where I2C writes go.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned int uint;
+
+enum gpio_function { GPIO_FUNC_I2C = 3 };
+
+void stdio_init_all(void);
+int putchar_raw(int c);
+void sleep_ms(uint32_t ms);
+void sleep_us(uint64_t us);
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+void gpio_set_function(uint gpio, enum gpio_function fn);
+void gpio_pull_up(uint gpio);
+
+static inline void tight_loop_contents(void) {}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_PICO_STDLIB_H */
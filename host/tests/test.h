@@ -0,0 +1,27 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+/* Minimal checks for the host tests: each failure is printed, main returns test_result() */
+
+#include <stdio.h>
+
+static int test_failures;
+
+#define CHECK(cond, ...)                                                   \
+  do {                                                                     \
+    if (!(cond)) {                                                         \
+      test_failures++;                                                     \
+      fprintf(stderr, "%s:%d: check failed: %s: ", __FILE__, __LINE__, #cond); \
+      fprintf(stderr, __VA_ARGS__);                                        \
+      fprintf(stderr, "\n");                                               \
+    }                                                                      \
+  } while (0)
+
+static inline int test_result(void) {
+  if (test_failures) {
+    fprintf(stderr, "%d checks failed\n", test_failures);
+  }
+  return test_failures != 0;
+}
+
+#endif /* HOST_TEST_H */
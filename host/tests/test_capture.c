@@ -0,0 +1,120 @@
+/*
+ * The double-buffer logic in fft_capture.c, driven one DMA step at a time
+ * through the host stand-in's manual capture mode: the order buffers are
+ * handed out in, overruns, dropped buffers and that consecutive buffers
+ * hold consecutive samples.
+ */
+#include "pico/fft.h"
+#include "host_hal.h"
+#include "test.h"
+
+#define COUNT 100
+#define INPUT_LEN 100000
+
+static uint8_t buf_a[COUNT], buf_b[COUNT];
+static uint32_t next_value;
+
+static void check_stats(uint32_t frames, uint32_t dropped, uint32_t overruns);
+static void check_samples(const uint8_t *buf);
+
+int main() {
+  static float input[INPUT_LEN];
+  uint8_t *buf;
+
+  // Sample i reads back as i & 0xff
+  for (int i = 0; i < INPUT_LEN; i++) {
+    input[i] = ((i & 0xff) - 128) / 128.0f;
+  }
+  host_input_set(input, INPUT_LEN, FSAMP);
+  host_capture_manual(true);
+
+  CHECK(fft_capture_acquire() == NULL, "acquire before start");
+  CHECK(fft_capture_start(buf_a, buf_b, COUNT), "start");
+  CHECK(fft_capture_acquire() == NULL, "acquire before the first buffer is full");
+  host_capture_advance(COUNT - 1);
+  CHECK(fft_capture_acquire() == NULL, "acquire of a partly filled buffer");
+
+  // Buffers come out in order, a then b then a
+  host_capture_advance(1);
+  buf = fft_capture_acquire();
+  CHECK(buf == buf_a, "first buffer is buf_a");
+  CHECK(fft_capture_acquire() == NULL, "second acquire while one is held");
+  check_samples(buf);
+  CHECK(fft_capture_release(buf), "release in time");
+  CHECK(fft_capture_acquire() == NULL, "acquire with nothing new");
+
+  host_capture_advance(COUNT);
+  buf = fft_capture_acquire();
+  CHECK(buf == buf_b, "second buffer is buf_b");
+  check_samples(buf);
+  CHECK(fft_capture_release(buf), "release in time");
+
+  host_capture_advance(COUNT);
+  buf = fft_capture_acquire();
+  CHECK(buf == buf_a, "third buffer is buf_a");
+  check_samples(buf);
+  // Releasing something else does not count
+  CHECK(!fft_capture_release(buf_b), "release of a buffer that is not held");
+  check_stats(3, 0, 0);
+
+  // Two buffers fill without an acquire: the older one is dropped, the newer one handed out
+  host_capture_advance(2 * COUNT);
+  check_stats(5, 1, 0);
+  buf = fft_capture_acquire();
+  CHECK(buf == buf_a, "newest buffer after a drop is buf_a");
+  next_value += COUNT;
+  check_samples(buf);
+  CHECK(fft_capture_release(buf), "release in time");
+
+  // Held across the next completion: the DMA is now writing into it
+  host_capture_advance(COUNT);
+  buf = fft_capture_acquire();
+  CHECK(buf == buf_b, "buf_b");
+  host_capture_advance(COUNT);
+  CHECK(!fft_capture_release(buf), "release after the DMA came round reports the overrun");
+  check_stats(7, 1, 1);
+
+  // Still in step afterwards
+  buf = fft_capture_acquire();
+  CHECK(buf == buf_a, "buf_a after the overrun");
+  next_value += COUNT;
+  check_samples(buf);
+  CHECK(fft_capture_release(buf), "release in time");
+
+  fft_capture_stop();
+  CHECK(fft_capture_acquire() == NULL, "acquire after stop");
+
+  // The capture thread delivers buffers at the ADC rate, one every 12.5 ms here
+  host_capture_manual(false);
+  CHECK(fft_capture_start(buf_a, buf_b, COUNT), "start with the capture thread");
+  int acquired = 0;
+  for (uint64_t start = time_us_64(); acquired < 3 && time_us_64() - start < 2000000;) {
+    if ((buf = fft_capture_acquire())) {
+      acquired++;
+      fft_capture_release(buf);
+    }
+  }
+  fft_capture_stop();
+  CHECK(acquired == 3, "%d buffers from the capture thread", acquired);
+  return test_result();
+}
+
+static void check_stats(uint32_t frames, uint32_t dropped, uint32_t overruns) {
+  fft_capture_stats_t stats;
+
+  fft_capture_get_stats(&stats);
+  CHECK(stats.frames == frames && stats.dropped == dropped && stats.overruns == overruns,
+        "stats %u frames, %u dropped, %u overruns, expected %u, %u, %u", stats.frames, stats.dropped, stats.overruns,
+        frames, dropped, overruns);
+}
+
+// The buffer continues the sample stream where the previous one acquired left off
+static void check_samples(const uint8_t *buf) {
+  for (int i = 0; i < COUNT; i++) {
+    if (buf[i] != ((next_value + i) & 0xff)) {
+      CHECK(buf[i] == ((next_value + i) & 0xff), "sample %u is %u", next_value + i, buf[i]);
+      break;
+    }
+  }
+  next_value += COUNT;
+}
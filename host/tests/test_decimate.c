@@ -0,0 +1,107 @@
+/*
+ * fft_decimate() against a double-precision reference: the CIC as its
+ * equivalent FIR (FFT_CIC_ORDER boxcars of cic_factor taps), normalised by
+ * cic_factor^FFT_CIC_ORDER, then the compensator taps. Every power-of-two
+ * factor up to FFT_CIC_MAX_FACTOR, with full-scale input.
+ */
+#include "pico/fft_decimate.h"
+#include "test.h"
+#include <stdlib.h>
+
+#define INPUT_LEN 8192
+#define TOLERANCE 3  // output LSBs, for the truncation after the CIC
+
+static uint8_t input[INPUT_LEN];
+static int16_t output[INPUT_LEN];
+static double cic_out[INPUT_LEN];
+
+static int reference(const fft_decimator_t *dec, int count);
+static void check_factor(int factor, const char *signal);
+
+int main() {
+  for (int factor = 1; factor <= FFT_CIC_MAX_FACTOR; factor *= 2) {
+    // Full-scale square wave: the CIC output reaches its extremes
+    for (int i = 0; i < INPUT_LEN; i++) {
+      input[i] = (i / 700) & 1 ? 255 : 0;
+    }
+    check_factor(factor, "square");
+
+    srand(factor);
+    for (int i = 0; i < INPUT_LEN; i++) {
+      input[i] = rand() & 0xff;
+    }
+    check_factor(factor, "noise");
+
+    for (int i = 0; i < INPUT_LEN; i++) {
+      input[i] = (uint8_t)lround(127.5 + 127.5 * sin(2 * M_PI * i / (40.0 * factor)));
+    }
+    check_factor(factor, "sine");
+  }
+
+  fft_decimator_t dec;
+  CHECK(!fft_decimator_init(&dec, 2 * FFT_CIC_MAX_FACTOR), "factor above the maximum accepted");
+  CHECK(!fft_decimator_init(&dec, 3), "factor that is not a power of two accepted");
+  return test_result();
+}
+
+static void check_factor(int factor, const char *signal) {
+  fft_decimator_t dec;
+  int worst = 0;
+
+  CHECK(fft_decimator_init(&dec, factor), "init %d", factor);
+  // In uneven chunks, to cover the state carried between calls
+  int produced = 0;
+  for (int pos = 0, chunk = 1; pos < INPUT_LEN; pos += chunk, chunk = chunk * 3 % 1000 + 1) {
+    int len = pos + chunk > INPUT_LEN ? INPUT_LEN - pos : chunk;
+    produced += fft_decimate(&dec, input + pos, len, output + produced);
+  }
+  int expected = reference(&dec, INPUT_LEN / factor);
+  CHECK(produced == expected, "factor %d %s: %d outputs, expected %d", factor, signal, produced, expected);
+
+  for (int j = 0; j < produced && j < expected; j++) {
+    // Output j is computed after CIC output 2j + 1
+    double acc = 0;
+    for (int n = 0; n < FFT_DECIM_TAPS; n++) {
+      int m = 2 * j + 1 - (FFT_DECIM_TAPS - 1) + n;
+      acc += m >= 0 ? dec.taps[n] / 32768.0 * cic_out[m] : 0;
+    }
+    acc = fmin(fmax(acc, INT16_MIN), INT16_MAX);
+    int error = abs(output[j] - (int)lround(acc));
+    if (error > worst) {
+      worst = error;
+    }
+  }
+  CHECK(worst <= TOLERANCE, "factor %d %s: error %d LSB", factor, signal, worst);
+}
+
+// Fills cic_out with the reference CIC outputs, in output LSBs; returns the FIR output count
+static int reference(const fft_decimator_t *dec, int count) {
+  int factor = dec->cic_factor;
+  int len = FFT_CIC_ORDER * (factor - 1) + 1;
+  double *h = calloc(len, sizeof(double));
+  double *t = calloc(len, sizeof(double));
+
+  h[0] = 1;
+  for (int stage = 0, hl = 1; stage < FFT_CIC_ORDER; stage++, hl += factor - 1) {
+    memset(t, 0, len * sizeof(double));
+    for (int k = 0; k < hl; k++) {
+      for (int b = 0; b < factor; b++) {
+        t[k + b] += h[k];
+      }
+    }
+    memcpy(h, t, len * sizeof(double));
+  }
+
+  double gain = pow(factor, FFT_CIC_ORDER) / (1 << FFT_DECIM_FRAC_BITS);
+  for (int m = 0; m < count; m++) {
+    int last = (m + 1) * factor - 1;
+    double acc = 0;
+    for (int k = 0; k < len && k <= last; k++) {
+      acc += h[k] * ((int)input[last - k] - 128);
+    }
+    cic_out[m] = acc / gain;
+  }
+  free(t);
+  free(h);
+  return count / 2;
+}
@@ -0,0 +1,90 @@
+/*
+ * fft_process_q15 and fft_process_q31 against the float path. The fixed
+ * point spectra are normalised by NSAMP and the input is Q15 of the 8-bit
+ * sample, so each energy should be the float power times (128 / NSAMP)^2.
+ * Bins are compared as amplitudes, the square root of their energy: the
+ * rounding in each FFT stage and the truncated Q31 squares add a floor of a
+ * few Q15 LSBs whatever the level, on top of a small relative error. One
+ * layout overlaps its bins, where only the first bin may count an output.
+ */
+#include "pico/fft.h"
+#include "test.h"
+
+#define BIN_COUNT 40
+#define BIN_HZ 100
+
+typedef struct {
+  const char *name;
+  void (*process)(uint8_t *, frequency_bin_fixed_t *, int);
+  double floor;     // amplitude error allowed at any level, in Q15 LSBs
+  double relative;  // and in proportion to the amplitude
+} fixed_path_t;
+
+static void make_input(uint8_t *samples, int offset, float level, uint32_t seed);
+static void compare(const fixed_path_t *path, uint8_t *samples, int width, const char *what);
+
+int main() {
+  static const fixed_path_t paths[] = {
+    {"q15", fft_process_q15, 8.0, 0.01},
+    {"q31", fft_process_q31, 1.5, 1e-3},
+  };
+  static const fft_window_t windows[] = {FFT_WINDOW_RECT, FFT_WINDOW_HANN};
+  static uint8_t samples[NSAMP];
+  char what[64];
+
+  fft_setup();
+  for (size_t w = 0; w < sizeof(windows) / sizeof(windows[0]); w++) {
+    fft_set_window(windows[w]);
+    for (size_t p = 0; p < sizeof(paths) / sizeof(paths[0]); p++) {
+      // Full scale, quiet and off-centre frames
+      make_input(samples, 0, 1.0f, 1);
+      snprintf(what, sizeof(what), "window %d, full scale", (int)windows[w]);
+      compare(&paths[p], samples, BIN_HZ, what);
+      make_input(samples, 0, 0.1f, 2);
+      snprintf(what, sizeof(what), "window %d, quiet", (int)windows[w]);
+      compare(&paths[p], samples, BIN_HZ, what);
+      make_input(samples, 20, 0.5f, 3);
+      snprintf(what, sizeof(what), "window %d, DC offset", (int)windows[w]);
+      compare(&paths[p], samples, BIN_HZ, what);
+      make_input(samples, 0, 1.0f, 4);
+      snprintf(what, sizeof(what), "window %d, overlapping bins", (int)windows[w]);
+      compare(&paths[p], samples, BIN_HZ * 3 / 2, what);
+    }
+  }
+  return test_result();
+}
+
+// Two partials off the FFT grid plus a little noise, scaled by level and moved by offset
+static void make_input(uint8_t *samples, int offset, float level, uint32_t seed) {
+  for (int i = 0; i < NSAMP; i++) {
+    float t = (float)i / FSAMP;
+    float x = 80 * sinf(2 * (float)M_PI * 441.3f * t) + 30 * sinf(2 * (float)M_PI * 1733.7f * t + 1);
+    seed = seed * 1664525 + 1013904223;
+    x = x * level + (int)(seed >> 30) - 2;
+    samples[i] = (uint8_t)lroundf(128 + offset + x);
+  }
+}
+
+static void compare(const fixed_path_t *path, uint8_t *samples, int width, const char *what) {
+  static frequency_bin_t bins[BIN_COUNT];
+  static frequency_bin_fixed_t bins_fixed[BIN_COUNT];
+  const double scale = 128.0 / NSAMP;
+  double total = 0;
+
+  for (int j = 0; j < BIN_COUNT; j++) {
+    bins[j].name = bins_fixed[j].name = "bin";
+    bins[j].freq_min = bins_fixed[j].freq_min = j * BIN_HZ;
+    bins[j].freq_max = bins_fixed[j].freq_max = j * BIN_HZ + width;
+  }
+  fft_process_scaled(samples, bins, BIN_COUNT, FFT_SCALE_MAGNITUDE);
+  path->process(samples, bins_fixed, BIN_COUNT);
+
+  for (int j = 0; j < BIN_COUNT; j++) {
+    double expected = bins[j].amplitude * scale;
+    double amplitude = sqrt((double)bins_fixed[j].energy);
+    total += bins_fixed[j].energy;
+    CHECK(fabs(amplitude - expected) <= path->floor + path->relative * expected,
+          "%s, %s: bin %d amplitude %.2f, float %.2f", path->name, what, j, amplitude, expected);
+  }
+  CHECK(total > 0, "%s, %s: no energy", path->name, what);
+}
@@ -0,0 +1,83 @@
+/*
+ * The iterative kiss_fft (digit-reversed gather or in-place permutation,
+ * then the butterfly stages) against the recursive kf_work it replaced, in
+ * kiss_fft_recursive.c. Both run the same butterflies on the same plan, so
+ * every output must be bit for bit the same: out of place, in place with a
+ * cycle table, strided, and in place without a cycle table above
+ * KF_CYCLES_MAX_NFFT.
+ */
+#include "pico/_kiss_fft_guts.h"
+#include "test.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+void kiss_fft_recursive_stride(kiss_fft_cfg st, const kiss_fft_cpx *fin, kiss_fft_cpx *fout, int in_stride);
+
+static void fill(kiss_fft_cpx *buf, int count, uint32_t seed);
+static void compare(int nfft, bool inverse);
+
+int main() {
+  // Radix 4, 2, 3 and 5 alone and mixed; 7, 11 and 17 take kf_bfly_generic on its stack scratch, 19 on the heap
+  static const int sizes[] = {
+    2, 3, 4, 5, 7, 8, 16, 32, 9, 27, 25, 125, 12, 30, 60, 2000, 1024, 4096, 11, 49, 77, 34, 19, 38, 76, 1000,
+    65536 + 4096, 131072,
+  };
+
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    compare(sizes[s], false);
+    compare(sizes[s], true);
+  }
+  return test_result();
+}
+
+static void fill(kiss_fft_cpx *buf, int count, uint32_t seed) {
+  for (int i = 0; i < count; i++) {
+    seed = seed * 1664525 + 1013904223;
+    buf[i].r = (int32_t)seed / 2147483648.0f;
+    seed = seed * 1664525 + 1013904223;
+    buf[i].i = (int32_t)seed / 2147483648.0f;
+  }
+}
+
+static void compare(int nfft, bool inverse) {
+  const int stride = 3;
+  kiss_fft_cfg cfg = kiss_fft_alloc(nfft, inverse, NULL, NULL);
+  kiss_fft_cpx *in = malloc(sizeof(kiss_fft_cpx) * nfft * stride);
+  kiss_fft_cpx *expected = malloc(sizeof(kiss_fft_cpx) * nfft);
+  kiss_fft_cpx *out = malloc(sizeof(kiss_fft_cpx) * nfft);
+  size_t bytes = sizeof(kiss_fft_cpx) * nfft;
+
+  CHECK(cfg && in && expected && out, "nfft %d: out of memory", nfft);
+  if (!cfg || !in || !expected || !out) {
+    free(cfg), free(in), free(expected), free(out);
+    return;
+  }
+  CHECK((cfg->cycles != NULL) == (nfft <= KF_CYCLES_MAX_NFFT), "nfft %d: cycle table %p", nfft, (void *)cfg->cycles);
+
+  fill(in, nfft * stride, nfft);
+  kiss_fft_recursive_stride(cfg, in, expected, 1);
+
+  kiss_fft(cfg, in, out);
+  CHECK(memcmp(out, expected, bytes) == 0, "nfft %d%s: out of place differs", nfft, inverse ? " inverse" : "");
+
+  memcpy(out, in, bytes);
+  kiss_fft(cfg, out, out);
+  CHECK(memcmp(out, expected, bytes) == 0, "nfft %d%s: in place differs", nfft, inverse ? " inverse" : "");
+
+  kiss_fft_recursive_stride(cfg, in, expected, stride);
+  kiss_fft_stride(cfg, in, out, stride);
+  CHECK(memcmp(out, expected, bytes) == 0, "nfft %d%s: stride %d differs", nfft, inverse ? " inverse" : "", stride);
+
+  // In place with a stride has no cycle table to use
+  kiss_fft_recursive_stride(cfg, in, expected, stride);
+  kiss_fft_stride(cfg, in, in, stride);
+  CHECK(memcmp(in, expected, bytes) == 0, "nfft %d%s: in place stride %d differs", nfft, inverse ? " inverse" : "",
+        stride);
+
+  free(out);
+  free(expected);
+  free(in);
+  free(cfg);
+}
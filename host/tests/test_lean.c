@@ -0,0 +1,75 @@
+/*
+ * fft_lean_process against fft_process at nfft = NSAMP, where both put their
+ * outputs on the same frequencies. The bins overlap, nest and include an
+ * empty one, so an output inside several of them must count only in the
+ * first, as compute_bin_amplitudes does. The lean path windows in the
+ * frequency domain and removes the mean by dropping X[0], so the two agree
+ * to rounding rather than bit for bit.
+ */
+#include <string.h>
+
+#include "pico/fft_lean.h"
+#include "test.h"
+
+#define BIN_COUNT 24
+
+static void make_bins(frequency_bin_t *bins);
+static void compare(const fft_lean_t *lean, const uint8_t *samples, fft_window_t window);
+
+int main() {
+  static const fft_window_t windows[] = {FFT_WINDOW_RECT, FFT_WINDOW_HANN};
+  static uint8_t samples[NSAMP];
+  static uint8_t mem[FFT_LEAN_MEM_SIZE(NSAMP)];
+  uint32_t seed = 1;
+
+  for (int i = 0; i < NSAMP; i++) {
+    float t = (float)i / FSAMP;
+    float x = 70 * sinf(2 * (float)M_PI * 441.3f * t) + 30 * sinf(2 * (float)M_PI * 1233.7f * t + 1);
+    seed = seed * 1664525 + 1013904223;
+    samples[i] = (uint8_t)lroundf(140 + x + (int)(seed >> 30) - 2);
+  }
+
+  fft_setup();
+  for (size_t w = 0; w < sizeof(windows) / sizeof(windows[0]); w++) {
+    fft_lean_t lean;
+    size_t lenmem = sizeof(mem);
+
+    CHECK(fft_lean_init(&lean, NSAMP, windows[w], mem, &lenmem), "window %d: init", (int)windows[w]);
+    fft_set_window(windows[w]);
+    compare(&lean, samples, windows[w]);
+  }
+  return test_result();
+}
+
+// 150 Hz bins every 100 Hz, then one inside an earlier bin, one spanning several and an empty one
+static void make_bins(frequency_bin_t *bins) {
+  for (int j = 0; j < BIN_COUNT - 3; j++) {
+    bins[j].name = "bin";
+    bins[j].freq_min = 300 + j * 100;
+    bins[j].freq_max = 450 + j * 100;
+  }
+  bins[BIN_COUNT - 3] = (frequency_bin_t){"nested", 420, 440, 0};
+  bins[BIN_COUNT - 2] = (frequency_bin_t){"wide", 100, 2800, 0};
+  bins[BIN_COUNT - 1] = (frequency_bin_t){"empty", 900, 900, 0};
+}
+
+static void compare(const fft_lean_t *lean, const uint8_t *samples, fft_window_t window) {
+  static float buf[NSAMP];
+  static uint8_t capture[NSAMP];
+  frequency_bin_t expected[BIN_COUNT];
+  frequency_bin_t bins[BIN_COUNT];
+
+  make_bins(expected);
+  make_bins(bins);
+  memcpy(capture, samples, NSAMP);
+  fft_process_scaled(capture, expected, BIN_COUNT, FFT_SCALE_MAGNITUDE);
+  fft_lean_process(lean, samples, buf, bins, BIN_COUNT);
+
+  for (int j = 0; j < BIN_COUNT; j++) {
+    CHECK(fabsf(bins[j].amplitude - expected[j].amplitude) <= 0.05f + 1e-4f * expected[j].amplitude,
+          "window %d: %s %d-%d amplitude %.3f, fft_process %.3f", (int)window, bins[j].name, bins[j].freq_min,
+          bins[j].freq_max, bins[j].amplitude, expected[j].amplitude);
+  }
+  CHECK(expected[BIN_COUNT - 2].amplitude > 0, "window %d: wide bin holds nothing", (int)window);
+  CHECK(bins[BIN_COUNT - 3].amplitude == 0, "window %d: nested bin counted", (int)window);
+}
@@ -0,0 +1,78 @@
+/*
+ * Nothing may be allocated once fft_setup() has returned: every analysis
+ * path runs from static memory. malloc, calloc and realloc are interposed
+ * and counted while the fft_process* functions run in a loop.
+ */
+#include "pico/fft.h"
+#include "test.h"
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static int allocations;
+static bool counting;
+
+void *malloc(size_t size) {
+  allocations += counting;
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+  allocations += counting;
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+  allocations += counting;
+  return __libc_realloc(ptr, size);
+}
+
+#define BIN_COUNT 64
+
+int main() {
+  static uint8_t samples[NSAMP];
+  static frequency_bin_t bins[BIN_COUNT];
+  static frequency_bin_fixed_t bins_fixed[BIN_COUNT];
+  static uint8_t db[BIN_COUNT];
+  static kiss_fft_cpx spectrum[NSAMP / 2 + 1];
+  static uint32_t bank_mem[(FFT_BIN_BANK_MEM_SIZE(BIN_COUNT) + 3) / 4];
+  static fft_stream_t stream;
+  fft_bin_bank_t bank;
+  size_t lenmem = sizeof(bank_mem);
+
+  for (int i = 0; i < NSAMP; i++) {
+    samples[i] = (uint8_t)(128 + 100 * sinf(2 * (float)M_PI * 110 * i / FSAMP));
+  }
+  for (int j = 0; j < BIN_COUNT; j++) {
+    bins[j].name = "bin";
+    bins[j].freq_min = j * 10;
+    bins[j].freq_max = j * 10 + 9;
+    bins_fixed[j].name = "bin";
+    bins_fixed[j].freq_min = j * 10;
+    bins_fixed[j].freq_max = j * 10 + 9;
+  }
+
+  fft_setup();
+  CHECK(fft_bin_bank_init(&bank, bins, BIN_COUNT, bank_mem, &lenmem), "bank");
+  fft_stream_init(&stream, NSAMP / 4);
+
+  counting = true;
+  for (int frame = 0; frame < 8; frame++) {
+    fft_set_window(frame & 1 ? FFT_WINDOW_HANN : FFT_WINDOW_RECT);
+    fft_process(samples, bins, BIN_COUNT);
+    fft_process_scaled(samples, bins, BIN_COUNT, FFT_SCALE_POWER);
+    fft_process_db8(samples, bins, BIN_COUNT, db);
+    fft_process_bank(samples, &bank);
+    fft_process_spectrum(samples, spectrum);
+    fft_process_q15(samples, bins_fixed, BIN_COUNT);
+    fft_process_q31(samples, bins_fixed, BIN_COUNT);
+    if (fft_stream_push(&stream, samples, NSAMP)) {
+      fft_stream_process(&stream, bins, BIN_COUNT);
+    }
+  }
+  counting = false;
+
+  CHECK(allocations == 0, "%d allocations after fft_setup()", allocations);
+  return test_result();
+}
@@ -0,0 +1,132 @@
+/*
+ * fft_ring on its own, then with a producer and a consumer thread. Each
+ * slot carries a sequence number and a payload derived from it, so the
+ * consumer sees any lost, repeated, reordered or half-written slot.
+ */
+#include "pico/fft_ring.h"
+#include "test.h"
+#include <pthread.h>
+#include <sched.h>
+
+#define CAPACITY 8
+#define WORDS 15
+#define ITEMS 500000
+
+typedef struct {
+  uint32_t sequence;
+  uint32_t payload[WORDS];
+} item_t;
+
+static fft_ring_t ring;
+static item_t storage[CAPACITY];
+static atomic_bool broken;  // the consumer gave up, so the producer must too
+
+static void check_single_thread();
+static void *producer_main(void *arg);
+static void *consumer_main(void *arg);
+
+int main() {
+  pthread_t producer, consumer;
+  uint32_t consumed = 0;
+
+  check_single_thread();
+
+  CHECK(fft_ring_init(&ring, storage, sizeof(item_t), CAPACITY), "init");
+  CHECK(pthread_create(&consumer, NULL, consumer_main, &consumed) == 0, "consumer thread");
+  CHECK(pthread_create(&producer, NULL, producer_main, NULL) == 0, "producer thread");
+  pthread_join(producer, NULL);
+  pthread_join(consumer, NULL);
+  CHECK(consumed == ITEMS, "%u of %u items consumed", consumed, ITEMS);
+  return test_result();
+}
+
+static void check_single_thread() {
+  uint32_t *slot;
+
+  CHECK(!fft_ring_init(&ring, storage, sizeof(item_t), 0), "capacity 0 accepted");
+  CHECK(!fft_ring_init(&ring, storage, sizeof(item_t), 6), "capacity 6 accepted");
+  CHECK(fft_ring_init(&ring, storage, sizeof(item_t), CAPACITY), "init");
+  CHECK(fft_ring_peek(&ring) == NULL, "peek on an empty ring");
+
+  // Fill, drain and refill so that the counters wrap past the capacity
+  for (uint32_t round = 0; round < 3; round++) {
+    for (uint32_t i = 0; i < CAPACITY; i++) {
+      slot = fft_ring_claim(&ring);
+      CHECK(slot != NULL, "round %u: claim %u failed", round, i);
+      if (slot) {
+        *slot = round * CAPACITY + i;
+        fft_ring_publish(&ring);
+      }
+    }
+    CHECK(fft_ring_claim(&ring) == NULL, "round %u: claim on a full ring", round);
+    for (uint32_t i = 0; i < CAPACITY; i++) {
+      slot = fft_ring_peek(&ring);
+      CHECK(slot && *slot == round * CAPACITY + i, "round %u: slot %u holds %u", round, i, slot ? *slot : 0);
+      fft_ring_release(&ring);
+    }
+    CHECK(fft_ring_peek(&ring) == NULL, "round %u: peek on a drained ring", round);
+  }
+
+  // Around the wrap of the unsigned counters
+  CHECK(fft_ring_init(&ring, storage, sizeof(item_t), CAPACITY), "init");
+  atomic_store(&ring.head, UINT32_MAX - 2);
+  atomic_store(&ring.tail, UINT32_MAX - 2);
+  for (uint32_t i = 0; i < CAPACITY; i++) {
+    slot = fft_ring_claim(&ring);
+    CHECK(slot != NULL, "wrap: claim %u failed", i);
+    if (slot) {
+      *slot = i;
+      fft_ring_publish(&ring);
+    }
+  }
+  CHECK(fft_ring_claim(&ring) == NULL, "wrap: claim on a full ring");
+  for (uint32_t i = 0; i < CAPACITY; i++) {
+    slot = fft_ring_peek(&ring);
+    CHECK(slot && *slot == i, "wrap: slot %u holds %u", i, slot ? *slot : 0);
+    fft_ring_release(&ring);
+  }
+  CHECK(fft_ring_peek(&ring) == NULL, "wrap: peek on a drained ring");
+}
+
+static void *producer_main(void *arg) {
+  (void)arg;
+  for (uint32_t sequence = 0; sequence < ITEMS && !atomic_load(&broken);) {
+    item_t *item = fft_ring_claim(&ring);
+    if (!item) {
+      sched_yield();  // on a single CPU spinning would only wait for the next tick
+      continue;
+    }
+    item->sequence = sequence;
+    for (int w = 0; w < WORDS; w++) {
+      item->payload[w] = sequence * 2654435761u + w;
+    }
+    fft_ring_publish(&ring);
+    sequence++;
+  }
+  return NULL;
+}
+
+// Stops at the first broken item rather than reporting every one after it
+static void *consumer_main(void *arg) {
+  uint32_t *consumed = arg;
+
+  while (*consumed < ITEMS) {
+    const item_t *item = fft_ring_peek(&ring);
+    if (!item) {
+      sched_yield();
+      continue;
+    }
+    bool intact = item->sequence == *consumed;
+    for (int w = 0; w < WORDS; w++) {
+      intact = intact && item->payload[w] == item->sequence * 2654435761u + w;
+    }
+    CHECK(intact, "item %u arrived as sequence %u", *consumed, item->sequence);
+    if (!intact) {
+      atomic_store(&broken, true);
+      return NULL;
+    }
+    fft_ring_release(&ring);
+    (*consumed)++;
+  }
+  return NULL;
+}
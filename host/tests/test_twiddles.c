@@ -0,0 +1,68 @@
+/*
+ * The build-time real FFT tables (fft_twiddles.cpp) against what
+ * kiss_fftr_alloc computes at run time for the same size and direction:
+ * nfft / 2 twiddles of the complex sub-FFT and nfft / 4 super twiddles.
+ * The constexpr series and libm's cos/sin both round from double, so every
+ * value must agree to within FLT_EPSILON, one float ULP at 1.
+ */
+#include "pico/fft.h"
+#include "pico/_kiss_fft_guts.h"
+#include "test.h"
+#include <float.h>
+
+static void check_table(int nfft, bool inverse, bool expected);
+static int compare_values(const kiss_fft_cpx *table, const kiss_fft_cpx *runtime, int count);
+
+int main() {
+  // The tables fft_twiddles.cpp builds in this configuration
+  check_table(2 * FFT_PITCH_NSAMP, false, true);
+  check_table(2 * FFT_PITCH_NSAMP, true, true);
+  check_table(NSAMP, false, !FFT_STATIC_KERNEL);
+#if FFT_LEAN_NFFT
+  check_table(FFT_LEAN_NFFT, false, true);
+#endif
+
+  // And none it does not
+  check_table(NSAMP, true, false);
+  check_table(4 * FFT_PITCH_NSAMP, false, false);
+  check_table(0, false, false);
+  return test_result();
+}
+
+static void check_table(int nfft, bool inverse, bool expected) {
+  const fft_twiddle_table_t *table = fft_twiddle_table_find(nfft, inverse);
+
+  CHECK((table != NULL) == expected, "nfft %d inverse %d: table %s", nfft, inverse, table ? "found" : "missing");
+  if (!table) {
+    return;
+  }
+  CHECK(table->nfft == nfft && table->inverse == inverse, "nfft %d inverse %d: found %d %d", nfft, inverse,
+        table->nfft, table->inverse);
+
+  kiss_fftr_cfg cfg = kiss_fftr_alloc(nfft, inverse, NULL, NULL);
+  CHECK(cfg != NULL, "nfft %d: kiss_fftr_alloc failed", nfft);
+  if (!cfg) {
+    return;
+  }
+  CHECK(cfg->substate->nfft == nfft / 2, "nfft %d: sub-FFT of %d points", nfft, cfg->substate->nfft);
+
+  int bad = compare_values(table->twiddles, cfg->substate->twiddles, nfft / 2);
+  CHECK(bad < 0, "nfft %d inverse %d: twiddle %d is %.9g%+.9gi, kiss_fftr_alloc has %.9g%+.9gi", nfft, inverse, bad,
+        bad < 0 ? 0 : table->twiddles[bad].r, bad < 0 ? 0 : table->twiddles[bad].i,
+        bad < 0 ? 0 : cfg->substate->twiddles[bad].r, bad < 0 ? 0 : cfg->substate->twiddles[bad].i);
+  bad = compare_values(table->super_twiddles, cfg->super_twiddles, nfft / 4);
+  CHECK(bad < 0, "nfft %d inverse %d: super twiddle %d is %.9g%+.9gi, kiss_fftr_alloc has %.9g%+.9gi", nfft,
+        inverse, bad, bad < 0 ? 0 : table->super_twiddles[bad].r, bad < 0 ? 0 : table->super_twiddles[bad].i,
+        bad < 0 ? 0 : cfg->super_twiddles[bad].r, bad < 0 ? 0 : cfg->super_twiddles[bad].i);
+  kiss_fftr_free(cfg);
+}
+
+// Index of the first value more than FLT_EPSILON away, -1 if there is none
+static int compare_values(const kiss_fft_cpx *table, const kiss_fft_cpx *runtime, int count) {
+  for (int k = 0; k < count; k++) {
+    if (fabsf(table[k].r - runtime[k].r) > FLT_EPSILON || fabsf(table[k].i - runtime[k].i) > FLT_EPSILON) {
+      return k;
+    }
+  }
+  return -1;
+}
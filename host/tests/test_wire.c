@@ -0,0 +1,374 @@
+/*
+ * fft_wire round trips: an encoded stream with delta-coded samples and dB8
+ * spectra decodes back to what was sent, a corrupted frame is rejected by
+ * its CRC and takes the delta frames that refer to it along, a decoder that
+ * joins late waits for the next keyframe, and frames hidden inside a false
+ * sync are still found. Sends that do not fit FFT_WIRE_MAX_PAYLOAD fail.
+ */
+#include "pico/fft_wire.h"
+#include "test.h"
+#include <math.h>
+#include <string.h>
+
+#define FRAMES 20
+#define SPECTRUM_VALUES 100
+#define MAX_DECODED (5 * FRAMES + 8)
+
+typedef struct {
+  uint8_t type;
+  uint8_t seq;
+  uint16_t length;
+  uint8_t payload[FFT_WIRE_MAX_PAYLOAD];
+} decoded_t;
+
+// Where each sample frame starts in the stream and how long it is
+typedef struct {
+  size_t offset;
+  size_t size;
+} sent_t;
+
+static uint8_t stream[1 << 20];
+static size_t stream_len;
+static decoded_t decoded[MAX_DECODED];
+static int decoded_count;
+static fft_wire_decoder_t decoder;
+
+static uint8_t samples[FRAMES][NSAMP];
+static uint8_t db[FRAMES][SPECTRUM_VALUES];
+static float power[SPECTRUM_VALUES];
+static sent_t sent_samples[FRAMES];
+
+static void write_stream(const uint8_t *data, size_t len);
+static void encode_stream();
+static void decode(const uint8_t *data, size_t len, bool flush);
+static int count_type(uint8_t type);
+static const decoded_t *find_samples(uint32_t time_us);
+static void check_round_trip();
+static void check_crc_error();
+static void check_late_join();
+static void check_false_sync();
+static void check_limits();
+
+int main() {
+  encode_stream();
+  check_round_trip();
+  check_crc_error();
+  check_late_join();
+  check_false_sync();
+  check_limits();
+  return test_result();
+}
+
+static void write_stream(const uint8_t *data, size_t len) {
+  if (stream_len + len <= sizeof(stream)) {
+    memcpy(stream + stream_len, data, len);
+  }
+  stream_len += len;
+}
+
+// Per frame: samples, a dB8 spectrum, a float spectrum, a Q15 spectrum and a pitch
+static void encode_stream() {
+  static fft_wire_encoder_t enc;
+  uint32_t seed = 1;
+
+  for (int i = 0; i < NSAMP; i++) {
+    samples[0][i] = (uint8_t)(128 + 90 * sinf(2 * (float)M_PI * 110 * i / FSAMP));
+  }
+  for (int j = 0; j < SPECTRUM_VALUES; j++) {
+    db[0][j] = (uint8_t)(j * 2);
+    power[j] = 1000.0f * j * j;
+  }
+  // Each frame changes a few samples and spectrum values, leaving runs of well over 256 unchanged bytes
+  for (int f = 1; f < FRAMES; f++) {
+    memcpy(samples[f], samples[f - 1], NSAMP);
+    memcpy(db[f], db[f - 1], SPECTRUM_VALUES);
+    for (int k = 0; k < 6; k++) {
+      seed = seed * 1664525 + 1013904223;
+      samples[f][(seed >> 8) % NSAMP] += (uint8_t)(seed >> 24) | 1;
+      db[f][(seed >> 16) % SPECTRUM_VALUES] += 3;
+    }
+  }
+
+  stream_len = 0;
+  fft_wire_init(&enc, write_stream, true);
+  for (int f = 0; f < FRAMES; f++) {
+    sent_samples[f].offset = stream_len;
+    CHECK(fft_wire_send_samples(&enc, samples[f], NSAMP, FSAMP, 1000 * f), "send samples %d", f);
+    sent_samples[f].size = stream_len - sent_samples[f].offset;
+    CHECK(fft_wire_send_spectrum_db8(&enc, db[f], SPECTRUM_VALUES, 0, 40), "send dB8 %d", f);
+    CHECK(fft_wire_send_spectrum_f32(&enc, power, SPECTRUM_VALUES, 0, 40), "send f32 %d", f);
+    CHECK(fft_wire_send_spectrum_q15(&enc, power, SPECTRUM_VALUES, 0, 40), "send Q15 %d", f);
+    CHECK(fft_wire_send_pitch(&enc, 110.0f + f, 0.9f, FFT_WIRE_PITCH_MPM), "send pitch %d", f);
+  }
+  CHECK(stream_len <= sizeof(stream), "stream of %zu bytes", stream_len);
+}
+
+// Keeps a copy of every decoded frame, as their payloads only last until the next byte
+static void decode(const uint8_t *data, size_t len, bool flush) {
+  fft_wire_frame_t frame;
+
+  fft_wire_decoder_init(&decoder);
+  decoded_count = 0;
+  for (size_t i = 0; i < len; i++) {
+    if (fft_wire_decode(&decoder, data[i], &frame) && decoded_count < MAX_DECODED) {
+      decoded[decoded_count].type = frame.type;
+      decoded[decoded_count].seq = frame.seq;
+      decoded[decoded_count].length = frame.length;
+      memcpy(decoded[decoded_count].payload, frame.payload, frame.length);
+      decoded_count++;
+    }
+  }
+  while (flush && fft_wire_decode_flush(&decoder, &frame) && decoded_count < MAX_DECODED) {
+    decoded[decoded_count].type = frame.type;
+    decoded[decoded_count].seq = frame.seq;
+    decoded[decoded_count].length = frame.length;
+    memcpy(decoded[decoded_count].payload, frame.payload, frame.length);
+    decoded_count++;
+  }
+}
+
+static int count_type(uint8_t type) {
+  int n = 0;
+  for (int i = 0; i < decoded_count; i++) {
+    n += decoded[i].type == type;
+  }
+  return n;
+}
+
+static const decoded_t *find_samples(uint32_t time_us) {
+  for (int i = 0; i < decoded_count; i++) {
+    fft_wire_frame_t frame = {decoded[i].type, decoded[i].seq, decoded[i].length, decoded[i].payload};
+    uint32_t rate, t;
+    const uint8_t *s;
+    int count;
+    if (fft_wire_get_samples(&frame, &rate, &t, &s, &count) && t == time_us) {
+      return &decoded[i];
+    }
+  }
+  return NULL;
+}
+
+static void check_round_trip() {
+  int f = 0, d = 0, q = 0, p = 0;
+
+  // Keyframes every FFT_WIRE_KEYFRAME_INTERVAL sample frames, delta frames in between
+  for (int i = 0; i < FRAMES; i++) {
+    bool key = i % FFT_WIRE_KEYFRAME_INTERVAL == 0;
+    size_t full = FFT_WIRE_HEADER_SIZE + 8 + NSAMP + FFT_WIRE_CRC_SIZE;
+    CHECK(key ? sent_samples[i].size == full : sent_samples[i].size < full / 10, "sample frame %d is %zu bytes", i,
+          sent_samples[i].size);
+    CHECK((stream[sent_samples[i].offset + 2] & FFT_WIRE_DELTA) == (key ? 0 : FFT_WIRE_DELTA), "sample frame %d type",
+          i);
+  }
+
+  decode(stream, stream_len, false);
+  CHECK(decoded_count == 5 * FRAMES, "%d frames decoded", decoded_count);
+  CHECK(decoder.crc_errors == 0 && decoder.missing_references == 0, "%u CRC errors, %u missing references",
+        decoder.crc_errors, decoder.missing_references);
+
+  for (int i = 0; i < decoded_count; i++) {
+    fft_wire_frame_t frame = {decoded[i].type, decoded[i].seq, decoded[i].length, decoded[i].payload};
+    fft_wire_spectrum_t spectrum;
+    uint32_t rate, time_us;
+    const uint8_t *s;
+    int count;
+    float freq, clarity;
+    uint8_t source;
+
+    CHECK(frame.seq == (uint8_t)i, "frame %d has seq %u", i, frame.seq);
+    if (fft_wire_get_samples(&frame, &rate, &time_us, &s, &count)) {
+      CHECK(rate == FSAMP && time_us == 1000u * f && count == NSAMP, "samples %d: %u Hz, %u us, %d samples", f, rate,
+            time_us, count);
+      CHECK(count == NSAMP && memcmp(s, samples[f], NSAMP) == 0, "samples %d differ", f);
+      f++;
+    } else if (fft_wire_get_spectrum(&frame, &spectrum)) {
+      CHECK(spectrum.count == SPECTRUM_VALUES && spectrum.step_hz == 40, "spectrum type %u: %d values every %g Hz",
+            spectrum.type, spectrum.count, spectrum.step_hz);
+      if (spectrum.type == FFT_WIRE_SPECTRUM_DB8) {
+        CHECK(memcmp(spectrum.values, db[d], SPECTRUM_VALUES) == 0, "dB8 spectrum %d differs", d);
+        d++;
+      } else {
+        // Q15 magnitudes are rounded to 64 * NSAMP / 32768 steps
+        float step = 64.0f * NSAMP / 32768.0f;
+        for (int j = 0; j < spectrum.count; j++) {
+          float m = sqrtf(fft_wire_spectrum_power(&spectrum, j));
+          float tolerance = spectrum.type == FFT_WIRE_SPECTRUM_Q15 ? step : 0;
+          CHECK(fabsf(m - sqrtf(power[j])) <= tolerance, "spectrum type %u value %d: %g", spectrum.type, j, m);
+        }
+        q++;
+      }
+    } else if (fft_wire_get_pitch(&frame, &freq, &clarity, &source)) {
+      CHECK(freq == 110.0f + p && clarity == 0.9f && source == FFT_WIRE_PITCH_MPM, "pitch %d: %g %g %u", p, freq,
+            clarity, source);
+      p++;
+    } else {
+      CHECK(false, "frame %d has unknown type %u", i, frame.type);
+    }
+  }
+  CHECK(f == FRAMES && d == FRAMES && q == 2 * FRAMES && p == FRAMES, "%d, %d, %d, %d frames by type", f, d, q, p);
+}
+
+// A flipped byte in sample frame 3 loses it and the delta frames up to the next keyframe, which all refer back to it
+static void check_crc_error() {
+  static uint8_t corrupt[sizeof(stream)];
+  int lost = FFT_WIRE_KEYFRAME_INTERVAL - 3;
+
+  memcpy(corrupt, stream, stream_len);
+  corrupt[sent_samples[3].offset + FFT_WIRE_HEADER_SIZE + 4] ^= 0x10;
+  decode(corrupt, stream_len, false);
+
+  CHECK(decoder.crc_errors == 1, "%u CRC errors", decoder.crc_errors);
+  CHECK(decoder.missing_references == (uint32_t)lost - 1, "%u missing references", decoder.missing_references);
+  CHECK(count_type(FFT_WIRE_SAMPLES) == FRAMES - lost, "%d sample frames", count_type(FFT_WIRE_SAMPLES));
+  CHECK(count_type(FFT_WIRE_PITCH) == FRAMES, "%d pitch frames", count_type(FFT_WIRE_PITCH));
+  CHECK(find_samples(2000) && !find_samples(3000) && !find_samples(15000), "frames around the error");
+  const decoded_t *key = find_samples(16000);
+  CHECK(key && memcmp(key->payload + 8, samples[16], NSAMP) == 0, "keyframe after the error");
+}
+
+// Starting at sample frame 5, the sample and dB8 delta frames wait for their keyframes
+static void check_late_join() {
+  size_t from = sent_samples[5].offset;
+  int skipped = FFT_WIRE_KEYFRAME_INTERVAL - 5;
+
+  decode(stream + from, stream_len - from, false);
+  CHECK(decoder.missing_references == 2 * (uint32_t)skipped, "%u missing references", decoder.missing_references);
+  CHECK(count_type(FFT_WIRE_SPECTRUM_DB8) == FRAMES - FFT_WIRE_KEYFRAME_INTERVAL, "%d dB8 frames",
+        count_type(FFT_WIRE_SPECTRUM_DB8));
+  CHECK(count_type(FFT_WIRE_SAMPLES) == FRAMES - FFT_WIRE_KEYFRAME_INTERVAL, "%d sample frames",
+        count_type(FFT_WIRE_SAMPLES));
+  const decoded_t *last = find_samples(1000 * (FRAMES - 1));
+  CHECK(last && memcmp(last->payload + 8, samples[FRAMES - 1], NSAMP) == 0, "last frame after joining late");
+}
+
+// Bytes that look like the start of a frame in front of real ones
+static void check_false_sync() {
+  static uint8_t buf[4096];
+  static const uint8_t plausible[] = {FFT_WIRE_SYNC0, FFT_WIRE_SYNC1, FFT_WIRE_PITCH, 0, 40, 0};
+  static const uint8_t too_long[] = {FFT_WIRE_SYNC0, FFT_WIRE_SYNC1, FFT_WIRE_PITCH, 0, 0xff, 0xff};
+  static const uint8_t unfinished[] = {FFT_WIRE_SYNC0, FFT_WIRE_SYNC1, FFT_WIRE_PITCH, 0, 0xe8, 0x03};
+  fft_wire_encoder_t enc;
+  size_t n;
+
+  // The false header claims 40 payload bytes, which swallows the first two real pitch frames
+  stream_len = 0;
+  write_stream(plausible, sizeof(plausible));
+  fft_wire_init(&enc, write_stream, false);
+  for (int i = 0; i < 4; i++) {
+    fft_wire_send_pitch(&enc, 100.0f + i, 0.5f, FFT_WIRE_PITCH_GOERTZEL);
+  }
+  n = stream_len;
+  memcpy(buf, stream, n);
+  decode(buf, n, false);
+  CHECK(decoded_count == 4 && decoder.crc_errors == 1, "behind a plausible header: %d frames, %u CRC errors",
+        decoded_count, decoder.crc_errors);
+
+  // A length over FFT_WIRE_MAX_PAYLOAD is given up on at once, and a repeated first sync byte is no obstacle
+  stream_len = 0;
+  write_stream(too_long, sizeof(too_long));
+  write_stream((const uint8_t[]){FFT_WIRE_SYNC0}, 1);
+  fft_wire_init(&enc, write_stream, false);
+  for (int i = 0; i < 4; i++) {
+    fft_wire_send_pitch(&enc, 100.0f + i, 0.5f, FFT_WIRE_PITCH_GOERTZEL);
+  }
+  n = stream_len;
+  memcpy(buf, stream, n);
+  decode(buf, n, false);
+  CHECK(decoded_count == 4 && decoder.crc_errors == 0, "behind an oversized header: %d frames, %u CRC errors",
+        decoded_count, decoder.crc_errors);
+
+  // A false header as long as a frame can be hides more bytes than the decoder holds at once
+  static const uint8_t longest[] = {FFT_WIRE_SYNC0, FFT_WIRE_SYNC1, FFT_WIRE_PITCH, 0,
+                                    FFT_WIRE_MAX_PAYLOAD & 0xff, FFT_WIRE_MAX_PAYLOAD >> 8};
+  static uint8_t big[2 * FFT_WIRE_MAX_FRAME];
+  const int pitch_frames = 2 * FFT_WIRE_MAX_FRAME / (FFT_WIRE_HEADER_SIZE + 9 + FFT_WIRE_CRC_SIZE) - 1;
+  stream_len = 0;
+  write_stream(longest, sizeof(longest));
+  fft_wire_init(&enc, write_stream, false);
+  for (int i = 0; i < pitch_frames; i++) {
+    fft_wire_send_pitch(&enc, 100.0f + i, 0.5f, FFT_WIRE_PITCH_GOERTZEL);
+  }
+  n = stream_len;
+  CHECK(n <= sizeof(big), "%zu bytes", n);
+  memcpy(big, stream, n);
+  decode(big, n, false);
+  CHECK(decoder.frames == (uint32_t)pitch_frames && decoder.crc_errors == 1,
+        "behind the longest header: %u of %d frames, %u CRC errors", decoder.frames, pitch_frames, decoder.crc_errors);
+
+  // A header promising 1000 bytes that never come: the frames inside are only found by the flush
+  stream_len = 0;
+  write_stream(unfinished, sizeof(unfinished));
+  fft_wire_init(&enc, write_stream, false);
+  for (int i = 0; i < 3; i++) {
+    fft_wire_send_pitch(&enc, 100.0f + i, 0.5f, FFT_WIRE_PITCH_GOERTZEL);
+  }
+  n = stream_len;
+  memcpy(buf, stream, n);
+  decode(buf, n, false);
+  CHECK(decoded_count == 0, "%d frames before the flush", decoded_count);
+  decode(buf, n, true);
+  CHECK(decoded_count == 3, "%d frames after the flush", decoded_count);
+  for (int i = 0; i < decoded_count; i++) {
+    fft_wire_frame_t frame = {decoded[i].type, decoded[i].seq, decoded[i].length, decoded[i].payload};
+    float freq, clarity;
+    uint8_t source;
+    CHECK(fft_wire_get_pitch(&frame, &freq, &clarity, &source) && freq == 100.0f + i &&
+              source == FFT_WIRE_PITCH_GOERTZEL,
+          "pitch %d after the flush", i);
+  }
+
+  // An 8-byte pitch payload from before the source byte decodes as unknown
+  uint8_t old[FFT_WIRE_HEADER_SIZE + 8 + FFT_WIRE_CRC_SIZE] = {FFT_WIRE_SYNC0, FFT_WIRE_SYNC1, FFT_WIRE_PITCH, 7, 8, 0};
+  float freq = 82.41f, clarity = 1;
+  memcpy(old + FFT_WIRE_HEADER_SIZE, &freq, 4);
+  memcpy(old + FFT_WIRE_HEADER_SIZE + 4, &clarity, 4);
+  uint16_t crc = fft_wire_crc16(0xffff, old + 2, FFT_WIRE_HEADER_SIZE - 2 + 8);
+  old[sizeof(old) - 2] = crc & 0xff;
+  old[sizeof(old) - 1] = crc >> 8;
+  decode(old, sizeof(old), false);
+  if (decoded_count == 1) {
+    fft_wire_frame_t frame = {decoded[0].type, decoded[0].seq, decoded[0].length, decoded[0].payload};
+    uint8_t source = 0xff;
+    CHECK(fft_wire_get_pitch(&frame, &freq, &clarity, &source) && freq == 82.41f &&
+              source == FFT_WIRE_PITCH_UNKNOWN,
+          "old pitch frame: %g Hz, source %u", freq, source);
+  } else {
+    CHECK(false, "old pitch frame: %d frames", decoded_count);
+  }
+}
+
+// Payloads up to FFT_WIRE_MAX_PAYLOAD go out and decode; one byte more writes nothing
+static void check_limits() {
+  static uint8_t bytes[FFT_WIRE_MAX_PAYLOAD];
+  static float values[FFT_WIRE_MAX_PAYLOAD / 2];
+  fft_wire_encoder_t enc;
+  const int f32_max = (FFT_WIRE_MAX_PAYLOAD - 8) / 4;
+  const int q15_max = (FFT_WIRE_MAX_PAYLOAD - 8) / 2;
+  const int bytes_max = FFT_WIRE_MAX_PAYLOAD - 8;
+
+  fft_wire_init(&enc, write_stream, true);
+  stream_len = 0;
+  CHECK(!fft_wire_send_samples(&enc, bytes, bytes_max + 1, FSAMP, 0), "oversized samples sent");
+  CHECK(!fft_wire_send_spectrum_db8(&enc, bytes, bytes_max + 1, 0, 1), "oversized dB8 spectrum sent");
+  CHECK(!fft_wire_send_spectrum_f32(&enc, values, f32_max + 1, 0, 1), "oversized float spectrum sent");
+  CHECK(!fft_wire_send_spectrum_q15(&enc, values, q15_max + 1, 0, 1), "oversized Q15 spectrum sent");
+  CHECK(!fft_wire_send_samples(&enc, bytes, -1, FSAMP, 0), "negative count sent");
+  CHECK(stream_len == 0, "%zu bytes written by failed sends", stream_len);
+
+  for (int i = 0; i < bytes_max; i++) {
+    bytes[i] = (uint8_t)(i * 7);
+  }
+  for (int i = 0; i < f32_max; i++) {
+    values[i] = (float)i;
+  }
+  CHECK(fft_wire_send_samples(&enc, bytes, bytes_max, FSAMP, 0), "largest samples frame");
+  CHECK(fft_wire_send_spectrum_db8(&enc, bytes, bytes_max, 0, 1), "largest dB8 spectrum");
+  CHECK(fft_wire_send_spectrum_f32(&enc, values, f32_max, 0, 1), "largest float spectrum");
+  CHECK(fft_wire_send_spectrum_q15(&enc, values, q15_max, 0, 1), "largest Q15 spectrum");
+  decode(stream, stream_len, false);
+  CHECK(decoded_count == 4, "%d of the largest frames decoded", decoded_count);
+  for (int i = 0; i < decoded_count; i++) {
+    CHECK(decoded[i].length == FFT_WIRE_MAX_PAYLOAD, "frame %d has %u bytes", i, decoded[i].length);
+  }
+  CHECK(decoded_count < 1 || memcmp(decoded[0].payload + 8, bytes, bytes_max) == 0, "largest samples differ");
+}
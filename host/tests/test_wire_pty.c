@@ -0,0 +1,196 @@
+/*
+ * tools/fft_wire_dump reading from a pty, standing in for the Pico's USB
+ * serial port. The pty starts in cooked mode, so the tool has to switch it
+ * to raw itself: the stream carries CR, ^C, ^D and XON/XOFF bytes that a
+ * line discipline would rewrite or swallow. Frames go in on the master in
+ * small chunks with pauses between them, so they reach the tool split
+ * across reads. Its recording must hold exactly the samples sent.
+ *
+ *   test_wire_pty <path to fft_wire_dump>
+ */
+#include "pico/fft_record.h"
+#include "pico/fft_wire.h"
+#include "test.h"
+#include <fcntl.h>
+#include <pty.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define FRAMES 20  // past FFT_WIRE_KEYFRAME_INTERVAL, so delta frames are sent too
+#define WAIT_MS 5000
+
+static uint8_t stream[1 << 20];
+static size_t stream_len;
+static uint8_t samples[FRAMES][NSAMP];
+static uint8_t recording[1 << 20];
+
+static void write_stream(const uint8_t *data, size_t len);
+static void encode_stream();
+static pid_t start_dump(const char *tool, const char *device, const char *record_path, int *err_fd);
+static bool wait_for_raw(int master);
+static void send_in_chunks(int master);
+static void wait_for_drain(int slave);
+static void check_recording(const char *record_path);
+
+int main(int argc, char **argv) {
+  char device[64];
+  char record_path[64];
+  char summary[256] = "";
+  char expected[256];
+  int master, slave, err_fd;
+
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s <fft_wire_dump>\n", argv[0]);
+    return 2;
+  }
+  alarm(60);  // a tool stuck on a read fails the test instead of hanging it
+  encode_stream();
+
+  // Default termios: cooked, echoing, with CR translated to NL
+  if (openpty(&master, &slave, device, NULL, NULL) != 0) {
+    fprintf(stderr, "Failed to open a pty\n");
+    return 1;
+  }
+  // The tool must not hold the master open too, or closing ours would not hang up
+  fcntl(master, F_SETFD, FD_CLOEXEC);
+  fcntl(slave, F_SETFD, FD_CLOEXEC);
+  snprintf(record_path, sizeof(record_path), "wire_pty_%d.frec", (int)getpid());
+  pid_t pid = start_dump(argv[1], device, record_path, &err_fd);
+  CHECK(pid > 0, "failed to start %s", argv[1]);
+  if (pid <= 0) {
+    return test_result();
+  }
+
+  CHECK(wait_for_raw(master), "%s did not put %s in raw mode", argv[1], device);
+  send_in_chunks(master);
+  wait_for_drain(slave);
+  // Hanging up ends the tool's read loop
+  close(master);
+  close(slave);
+
+  int status;
+  waitpid(pid, &status, 0);
+  ssize_t n = read(err_fd, summary, sizeof(summary) - 1);
+  summary[n > 0 ? n : 0] = 0;
+  close(err_fd);
+  CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0, "fft_wire_dump exited with status %d", status);
+
+  snprintf(expected, sizeof(expected), "%d frames, 0 CRC errors, 0 delta frames without a reference", 2 * FRAMES);
+  CHECK(strstr(summary, expected) != NULL, "summary \"%s\", expected \"%s\"", summary, expected);
+  check_recording(record_path);
+  unlink(record_path);
+  return test_result();
+}
+
+static void write_stream(const uint8_t *data, size_t len) {
+  memcpy(stream + stream_len, data, len);
+  stream_len += len;
+}
+
+// Every byte value shows up in the samples, and in the deltas between frames
+static void encode_stream() {
+  fft_wire_encoder_t enc;
+
+  fft_wire_init(&enc, write_stream, true);
+  for (int f = 0; f < FRAMES; f++) {
+    for (int i = 0; i < NSAMP; i++) {
+      samples[f][i] = (uint8_t)(i < NSAMP / 2 ? i * 7 + f : (i / 16) * 3 + (f & 3));
+    }
+    fft_wire_send_samples(&enc, samples[f], NSAMP, FSAMP, f * 250000);
+    fft_wire_send_pitch(&enc, 100.0f + f, 0.9f, FFT_WIRE_PITCH_MPM);
+  }
+}
+
+// fft_wire_dump on the pty slave, recording to record_path; its stderr comes back through err_fd
+static pid_t start_dump(const char *tool, const char *device, const char *record_path, int *err_fd) {
+  int err[2];
+
+  if (pipe(err) != 0) {
+    return -1;
+  }
+  pid_t pid = fork();
+  if (pid == 0) {
+    int null_fd = open("/dev/null", O_WRONLY);
+    dup2(null_fd, STDOUT_FILENO);
+    dup2(err[1], STDERR_FILENO);
+    close(err[0]);
+    execl(tool, tool, "-r", record_path, device, (char *)NULL);
+    _exit(127);
+  }
+  close(err[1]);
+  *err_fd = err[0];
+  return pid;
+}
+
+// The master reports the slave's termios, so this sees the tool's tcsetattr
+static bool wait_for_raw(int master) {
+  struct termios tio;
+
+  for (int ms = 0; ms < WAIT_MS; ms++) {
+    if (tcgetattr(master, &tio) == 0 && !(tio.c_lflag & (ICANON | ECHO)) && !(tio.c_iflag & (ICRNL | IXON))) {
+      return true;
+    }
+    usleep(1000);
+  }
+  return false;
+}
+
+// Chunk sizes that cut through headers, payloads and CRCs, with a pause after each so that reads see them apart
+static void send_in_chunks(int master) {
+  static const size_t sizes[] = {1, 2, 5, 6, 7, 64, 333, 1000, 4097};
+  size_t sent = 0;
+
+  for (int c = 0; sent < stream_len; c++) {
+    size_t size = sizes[c % (sizeof(sizes) / sizeof(sizes[0]))];
+    if (size > stream_len - sent) {
+      size = stream_len - sent;
+    }
+    for (size_t done = 0; done < size;) {
+      ssize_t n = write(master, stream + sent + done, size - done);
+      if (n <= 0) {
+        CHECK(n > 0, "write to the pty master failed");
+        return;
+      }
+      done += n;
+    }
+    sent += size;
+    usleep(500);
+  }
+}
+
+// Hanging up may drop input the tool has not read yet, so wait until the slave's queue stays empty
+static void wait_for_drain(int slave) {
+  int quiet = 0;
+
+  for (int ms = 0; ms < WAIT_MS && quiet < 50; ms++) {
+    int pending = 0;
+    ioctl(slave, FIONREAD, &pending);
+    quiet = pending ? 0 : quiet + 1;
+    usleep(1000);
+  }
+}
+
+static void check_recording(const char *record_path) {
+  fft_recording_t rec;
+  FILE *f = fopen(record_path, "rb");
+
+  CHECK(f != NULL, "no recording at %s", record_path);
+  if (!f) {
+    return;
+  }
+  size_t size = fread(recording, 1, sizeof(recording), f);
+  fclose(f);
+
+  CHECK(fft_record_open(&rec, recording, size), "recording does not open");
+  CHECK(rec.frame_count == FRAMES, "%u frames recorded, %d sent", rec.frame_count, FRAMES);
+  for (uint32_t i = 0; i < rec.frame_count && i < FRAMES; i++) {
+    const fft_record_frame_t *frame = fft_record_frame(&rec, i);
+    CHECK(memcmp(fft_record_samples(&rec, frame), samples[i], NSAMP) == 0, "frame %u: samples differ", i);
+    CHECK(frame->pitch_hz == 100.0f + i, "frame %u: pitch %.2f, sent %.2f", i, frame->pitch_hz, 100.0f + i);
+  }
+}
@@ -0,0 +1,374 @@
+// oled.c
+// SSD1306 128x32 display on i2c0, drawn through a local page buffer
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include <string.h>
+#include "oled.h"
+
+// Columns of each page changed since the last oled_present(), none when start > end
+static uint8_t dirty_start[OLED_PAGES];
+static uint8_t dirty_end[OLED_PAGES];
+// What the display shows, valid once everything has been sent after oled_init()
+static uint8_t shown_buffer[OLED_WIDTH * OLED_PAGES];
+static bool shown_valid;
+
+static void mark_dirty(int page, int col_start, int col_end);
+static void mark_all_dirty();
+
+// ------------------- Basic OLED commands -------------------
+static void oled_cmd(i2c_inst_t *i2c, uint8_t cmd) {
+    uint8_t data[2] = {0x00, cmd};
+    i2c_write_blocking(i2c, OLED_ADDR, data, 2, false);
+}
+
+void oled_init() {
+    const uint8_t init_sequence[] = {
+        0xAE,             // display off
+        0x20, 0x00,       // memory addressing mode 0=horizontal
+        0xB0,             // set page start address
+        0xC8,             // COM scan direction
+        0x00, 0x10,       // column address
+        0x40,             // start line
+        0x81, 0x7F,       // contrast
+        0xA1,             // segment remap
+        0xA6,             // normal display
+        0xA8, 0x1F,       // multiplex 32
+        0xA4,             // display all on resume
+        0xD3, 0x00,       // display offset
+        0xD5, 0xF0,       // display clock
+        0xD9, 0x22,       // pre-charge
+        0xDA, 0x02,       // COM pins
+        0xDB, 0x20,       // vcom detect
+        0x8D, 0x14,       // charge pump
+        0xAF              // display on
+    };
+
+    uint8_t buf[2];
+    for (int i = 0; i < sizeof(init_sequence); i++) {
+        buf[0] = 0x00;  // command
+        buf[1] = init_sequence[i];
+        i2c_write_blocking(i2c0, OLED_ADDR, buf, 2, false);
+    }
+    shown_valid = false;
+    mark_all_dirty();
+}
+
+uint8_t display_buffer[OLED_WIDTH * OLED_PAGES]; // 128x32 / 8 = 4 pages
+
+void oled_draw_pixel(int x, int y, bool on) {
+    if (x < 0 || x >= 128 || y < 0 || y >= 32) return;
+    int page = y / 8;
+    int bit = y % 8;
+    uint8_t before = display_buffer[x + page * 128];
+    uint8_t after = on ? before | (1 << bit) : before & ~(1 << bit);
+    if (after != before) {
+        display_buffer[x + page * 128] = after;
+        mark_dirty(page, x, x);
+    }
+}
+
+// Sends the changed span of each dirty page, using the column and page
+// address windows of horizontal addressing mode
+void oled_present() {
+    uint8_t buf[OLED_WIDTH + 1];
+    buf[0] = 0x40; // data prefix
+    for (int page = 0; page < OLED_PAGES; page++) {
+        const uint8_t *row = &display_buffer[page * OLED_WIDTH];
+        uint8_t *shown = &shown_buffer[page * OLED_WIDTH];
+        int start = dirty_start[page];
+        int end = dirty_end[page];
+
+        dirty_start[page] = OLED_WIDTH;
+        dirty_end[page] = 0;
+        // Pixels drawn back to what is already shown need not be sent
+        if (shown_valid) {
+            while (start <= end && row[start] == shown[start]) start++;
+            while (end >= start && row[end] == shown[end]) end--;
+        }
+        if (start > end) continue;
+
+        uint8_t cmd[7] = {0x00, 0x21, start, end, 0x22, page, page};
+        i2c_write_blocking(i2c0, OLED_ADDR, cmd, 7, false);
+        memcpy(buf + 1, row + start, end - start + 1);
+        i2c_write_blocking(i2c0, OLED_ADDR, buf, end - start + 2, false);
+        memcpy(shown + start, row + start, end - start + 1);
+    }
+    shown_valid = true;
+}
+
+void oled_show() {
+    shown_valid = false;
+    mark_all_dirty();
+    oled_present();
+}
+
+const uint32_t A_bitmap[32] = {
+    0b00000000001111111100000000000000,
+    0b00000000011111111110000000000000,
+    0b00000000111111111111000000000000,
+    0b00000001111100011111100000000000,
+    0b00000011111000001111110000000000,
+    0b00000111110000000111111000000000,
+    0b00001111100000000011111100000000,
+    0b00011111000000000001111110000000,
+    0b00111110000000000000111111000000,
+    0b01111100000000000000011111100000,
+    0b11111000000000000000001111110000,
+    0b11111111111111111111111111110000,
+    0b11111111111111111111111111110000,
+    0b11111000000000000000000011110000,
+    0b11111000000000000000000011110000,
+    0b11111000000000000000000011110000,
+    0b11111000000000000000000011110000,
+    0b11111000000000000000000011110000,
+    0b11111000000000000000000011110000,
+    0b11111000000000000000000011110000,
+    0b11111000000000000000000011110000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000
+};
+
+const uint32_t E_bitmap[32] = {
+    0b11111111111111111111111111110000,
+    0b11111111111111111111111111110000,
+    0b11110000000000000000000000000000,
+    0b11110000000000000000000000000000,
+    0b11110000000000000000000000000000,
+    0b11110000000000000000000000000000,
+    0b11110000000000000000000000000000,
+    0b11110000000000000000000000000000,
+    0b11110000000000000000000000000000,
+    0b11110000000000000000000000000000,
+    0b11111111111111111111111111110000,
+    0b11111111111111111111111111110000,
+    0b11110000000000000000000000000000,
+    0b11110000000000000000000000000000,
+    0b11110000000000000000000000000000,
+    0b11110000000000000000000000000000,
+    0b11110000000000000000000000000000,
+    0b11110000000000000000000000000000,
+    0b11110000000000000000000000000000,
+    0b11111111111111111111111111110000,
+    0b11111111111111111111111111110000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000
+};
+
+const uint32_t D_bitmap[32] = {
+    0b11111111111111111111111100000000,
+    0b11111111111111111111111100000000,
+    0b11110000000000000000111111110000,
+    0b11110000000000000000111111110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000111111110000,
+    0b11110000000000000000111111110000,
+    0b11111111111111111111111100000000,
+    0b11111111111111111111111100000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000
+};
+
+const uint32_t B_bitmap[32] = {
+    0b11111111111111111111111111100000,
+    0b11111111111111111111111111100000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11111111111111111111111111100000,
+    0b11111111111111111111111111100000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11110000000000000000000011110000,
+    0b11111111111111111111111111100000,
+    0b11111111111111111111111111100000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000
+};
+
+const uint32_t G_bitmap[32] = {
+    0b00000111111111111111111000000000,
+    0b00011111111111111111111110000000,
+    0b00111100000000000000011111000000,
+    0b01111000000000000000001111100000,
+    0b11110000000000000000000111110000,
+    0b11100000000000000000000011110000,
+    0b11100000000000000000000000000000,
+    0b11100000000000000000000000000000,
+    0b11100000000000000000000000000000,
+    0b11100000000000011111111111100000,
+    0b11100000000000111111111111100000,
+    0b11100000000000111111111111100000,
+    0b11100000000000000000000111110000,
+    0b11100000000000000000000011110000,
+    0b11100000000000000000000011110000,
+    0b11100000000000000000000011110000,
+    0b11100000000000000000000011110000,
+    0b11110000000000000000000111110000,
+    0b01111000000000000000001111100000,
+    0b00111100000000000000011111000000,
+    0b00011111111111111111111110000000,
+    0b00000111111111111111111000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000
+};
+
+const uint32_t Z_bitmap[32] = {
+    0b11111111111111111111111111110000,
+    0b11111111111111111111111111110000,
+    0b00000000000000000000000011110000,
+    0b00000000000000000000001111000000,
+    0b00000000000000000000111100000000,
+    0b00000000000000000011110000000000,
+    0b00000000000000000111100000000000,
+    0b00000000000000001111000000000000,
+    0b00000000000000011110000000000000,
+    0b00000000000000111100000000000000,
+    0b00000000000001111000000000000000,
+    0b00000000000011110000000000000000,
+    0b00000000000111100000000000000000,
+    0b00000000001111000000000000000000,
+    0b00000000011110000000000000000000,
+    0b00000000111100000000000000000000,
+    0b00000001111000000000000000000000,
+    0b00000011110000000000000000000000,
+    0b00000111100000000000000000000000,
+    0b00001111000000000000000000000000,
+    0b00111100000000000000000000000000,
+    0b11111111111111111111111111110000,
+    0b11111111111111111111111111110000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000
+};
+
+const uint32_t Rect_bitmap[32] = {
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+
+    0b00000000000011111111000000000000,
+    0b00000000000011111111000000000000,
+    0b00000000000011111111000000000000,
+    0b00000000000011111111000000000000,
+    0b00000000000011111111000000000000,
+    0b00000000000011111111000000000000,
+    0b00000000000011111111000000000000,
+    0b00000000000011111111000000000000,
+    0b00000000000011111111000000000000,
+    0b00000000000011111111000000000000,
+    0b00000000000011111111000000000000,
+
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000,
+    0b00000000000000000000000000000000
+};
+
+
+void oled_clear() {
+    memset(display_buffer, 0, sizeof(display_buffer)); // clear buffer
+    mark_all_dirty();
+}
+
+void draw_char(int x0, int y0, const uint32_t bitmap[32]) {
+    for (int y = 0; y < 32; y++) {
+        for (int x = 0; x < 32; x++) {
+            bool pixel_on = (bitmap[y] >> (31 - x)) & 1;
+            oled_draw_pixel(x0 + x, y0 + y, pixel_on);
+        }
+    }
+}
+
+static void mark_dirty(int page, int col_start, int col_end) {
+    if (col_start < dirty_start[page]) dirty_start[page] = col_start;
+    if (col_end > dirty_end[page]) dirty_end[page] = col_end;
+}
+
+static void mark_all_dirty() {
+    for (int page = 0; page < OLED_PAGES; page++) {
+        mark_dirty(page, 0, OLED_WIDTH - 1);
+    }
+}
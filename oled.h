@@ -0,0 +1,34 @@
+// oled.h
+#ifndef OLED_H
+#define OLED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define OLED_ADDR 0x3C
+#define OLED_WIDTH 128
+#define OLED_HEIGHT 32
+#define OLED_PAGES (OLED_HEIGHT / 8)
+
+// Draw through the functions below, direct writes are not tracked for oled_present()
+extern uint8_t display_buffer[OLED_WIDTH * OLED_PAGES];
+
+// 32x32 glyphs, one row per word with the leftmost pixel in bit 31
+extern const uint32_t A_bitmap[32];
+extern const uint32_t E_bitmap[32];
+extern const uint32_t D_bitmap[32];
+extern const uint32_t B_bitmap[32];
+extern const uint32_t G_bitmap[32];
+extern const uint32_t Z_bitmap[32];
+extern const uint32_t Rect_bitmap[32];
+
+void oled_init();
+// Drawing only changes the buffer; oled_present() then sends what changed, once per frame
+void oled_draw_pixel(int x, int y, bool on);
+void oled_clear();
+void draw_char(int x0, int y0, const uint32_t bitmap[32]);
+void oled_present();
+// Sends the whole buffer whether it changed or not
+void oled_show();
+
+#endif // OLED_H
@@ -1,14 +1,42 @@
 #include "pico/fft.h"
+#include "fft_batch.h"
+#include "fft_stages.h"
 
 static dma_channel_config cfg;
 static uint dma_chan;
 static float freqs[NSAMP];
+#if !FFT_STATIC_KERNEL
+static fft_plan_t default_plan;
+static uint64_t default_plan_mem[(FFT_PLAN_MEM_SIZE(NSAMP) + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+#endif
+static kiss_fftr_q15_cfg plan_q15;
+static uint64_t plan_q15_mem[(FFT_PLAN_MEM_SIZE(NSAMP) + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+static kiss_fftr_q31_cfg plan_q31;
+static uint64_t plan_q31_mem[(FFT_PLAN_MEM_SIZE(NSAMP) + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+static const fft_window_info_t *active_window;
+static int16_t db_table[32];   // log2 of the mantissa in 1/256 dB8 steps
+static int32_t db_octave;      // one octave of power in 1/256 dB8 steps
+#if FFT_BATCH_SIMD
+static float batch_rows[FFT_BATCH_MAX_LANES * NSAMP];
+#endif
 
+static bool default_plan_ready();
+static void default_fftr(const kiss_fft_scalar *fft_in, kiss_fft_cpx *fft_out);
 static void calculate_frequencies();
-static float calculate_average(uint8_t *buffer, int size);
-static void fill_fft_input(uint8_t *buffer, kiss_fft_scalar *fft_in, int size);
+static const fft_window_info_t *current_window();
+static float fill_fft_input(const uint8_t *buffer, kiss_fft_scalar *fft_in, int size);
+static float window_dc_leak(int term);
+static void remove_window_dc(kiss_fft_cpx *fft_out, float dc, int size);
+static fft_batch_kernel_t batch_kernel(int *lanes);
 static void reset_bins(frequency_bin_t *bins, int bin_count);
-static void compute_bin_amplitudes(kiss_fft_cpx *fft_out, frequency_bin_t *bins, int bin_count, int nsamp);
+static void compute_bin_amplitudes(kiss_fft_cpx *fft_out, frequency_bin_t *bins, int bin_count, int nsamp, fft_scale_t scale);
+static float output_magnitude(const kiss_fft_cpx *fft_out, int index);
+static void build_db_table();
+static int first_index_from(float freq);
+static float power_at(const kiss_fft_cpx *fft_out, int index);
+static int32_t average_q(uint32_t sum, int size, int frac_bits);
+static int index_from_hz(int hz);
+static void sum_bin_energy(uint32_t *power, frequency_bin_fixed_t *bins, int bin_count);
 
 void fft_setup() {
   stdio_init_all();
@@ -39,6 +67,30 @@ void fft_setup() {
   channel_config_set_dreq(&cfg, DREQ_ADC);
 
   calculate_frequencies();
+  default_plan_ready();
+}
+
+// Changes the ADC rate, e.g. to oversample ahead of fft_decimate(); the FSAMP-based frequency axis no longer applies
+void fft_set_sample_rate(float hz) {
+  adc_set_clkdiv(48000000.0f / hz);
+}
+
+// Window applied by every analysis path from the next frame on
+void fft_set_window(fft_window_t type) {
+  active_window = fft_window_get(type);
+}
+
+bool fft_plan_create(fft_plan_t *plan, int nfft, bool inverse, void *mem, size_t *lenmem) {
+  const fft_twiddle_table_t *table = fft_twiddle_table_find(nfft, inverse);
+
+  // Sizes with build-time tables point at flash instead of computing and storing twiddles
+  plan->nfft = nfft;
+  if (table) {
+    plan->cfg = kiss_fftr_alloc_static(nfft, inverse, table->twiddles, table->super_twiddles, mem, lenmem);
+  } else {
+    plan->cfg = kiss_fftr_alloc(nfft, inverse, mem, lenmem);
+  }
+  return plan->cfg != NULL;
 }
 
 
@@ -54,47 +106,490 @@ void fft_sample(uint8_t *capture_buf) {
   );
 
   adc_run(true);
+  FFT_PROFILE_BEGIN(FFT_STAGE_CAPTURE);
   dma_channel_wait_for_finish_blocking(dma_chan);
+  FFT_PROFILE_END(FFT_STAGE_CAPTURE);
 }
 
 void fft_process(uint8_t *capture_buf, frequency_bin_t *bins, int bin_count) {
+  fft_process_scaled(capture_buf, bins, bin_count, FFT_SCALE_MAGNITUDE);
+}
+
+void fft_process_scaled(uint8_t *capture_buf, frequency_bin_t *bins, int bin_count, fft_scale_t scale) {
   kiss_fft_scalar fft_in[NSAMP];
-  kiss_fft_cpx fft_out[NSAMP];
-  kiss_fftr_cfg cfg = kiss_fftr_alloc(NSAMP, false, NULL, NULL);
+  kiss_fft_cpx fft_out[NSAMP / 2 + 1];
 
-  if (!cfg) {
-    fprintf(stderr, "Failed to allocate FFT configuration\n");
+  if (!default_plan_ready()) {
     return;
   }
 
-  fill_fft_input(capture_buf, fft_in, NSAMP);
-  kiss_fftr(cfg, fft_in, fft_out);
+  FFT_PROFILE_BEGIN(FFT_STAGE_WINDOW);
+  float dc = fill_fft_input(capture_buf, fft_in, NSAMP);
+  FFT_PROFILE_END(FFT_STAGE_WINDOW);
+  default_fftr(fft_in, fft_out);
+  remove_window_dc(fft_out, dc, NSAMP);
+  FFT_PROFILE_BEGIN(FFT_STAGE_BINS);
   reset_bins(bins, bin_count);
-  compute_bin_amplitudes(fft_out, bins, bin_count, NSAMP);
-  kiss_fft_free(cfg);
+  compute_bin_amplitudes(fft_out, bins, bin_count, NSAMP, scale);
+  FFT_PROFILE_END(FFT_STAGE_BINS);
+}
+
+// Bin powers as 8-bit dB codes, see FFT_DB8_FLOOR_DB; bins[].amplitude is left holding the power
+void fft_process_db8(uint8_t *capture_buf, frequency_bin_t *bins, int bin_count, uint8_t *db) {
+  fft_process_scaled(capture_buf, bins, bin_count, FFT_SCALE_POWER);
+  for (int j = 0; j < bin_count; j++) {
+    fft_power_to_db8(&bins[j].amplitude, &db[j], 1);
+  }
+}
+
+// log2 from the float's exponent plus a 32-entry table on the top mantissa bits, no libm call per value
+void fft_power_to_db8(const float *power, uint8_t *db, int count) {
+  if (!db_octave) {
+    build_db_table();
+  }
+
+  for (int i = 0; i < count; i++) {
+    uint32_t bits;
+    memcpy(&bits, &power[i], sizeof(bits));
+    if (power[i] <= 0 || (bits >> 23) == 0) {
+      db[i] = 0;
+      continue;
+    }
+
+    int32_t exponent = (int32_t)(bits >> 23) - 127;
+    int32_t code = (exponent * db_octave + db_table[(bits >> 18) & 31] + 128) >> 8;
+    db[i] = code < 0 ? 0 : code > 255 ? 255 : (uint8_t)code;
+  }
+}
+
+bool fft_bin_bank_init(fft_bin_bank_t *bank, const frequency_bin_t *bins, int bin_count, void *mem, size_t *lenmem) {
+  size_t memneeded = FFT_BIN_BANK_MEM_SIZE(bin_count);
+
+  if (!mem || *lenmem < memneeded) {
+    *lenmem = memneeded;
+    return false;
+  }
+  *lenmem = memneeded;
+
+  bank->bin_count = bin_count;
+  bank->amplitude = (float *)mem;
+  bank->start = (uint16_t *)(bank->amplitude + bin_count);
+  bank->end = bank->start + bin_count;
+
+  calculate_frequencies();
+  for (int j = 0; j < bin_count; j++) {
+    if (bins) {
+      fft_bin_bank_set(bank, j, bins[j].freq_min, bins[j].freq_max);
+    } else {
+      bank->start[j] = bank->end[j] = 0;
+      bank->amplitude[j] = 0;
+    }
+  }
+  return true;
+}
+
+// Resolves one entry of an initialised bank to the FFT outputs from freq_min up to, not including, freq_max
+void fft_bin_bank_set(fft_bin_bank_t *bank, int index, float freq_min, float freq_max) {
+  bank->start[index] = first_index_from(freq_min);
+  bank->end[index] = first_index_from(freq_max);
+  if (bank->end[index] < bank->start[index]) {
+    bank->end[index] = bank->start[index];
+  }
+  bank->amplitude[index] = 0;
+}
+
+void fft_process_bank(uint8_t *capture_buf, fft_bin_bank_t *bank) {
+  kiss_fft_cpx fft_out[NSAMP / 2 + 1];
+
+  fft_process_spectrum(capture_buf, fft_out);
+  fft_bin_bank_accumulate(bank, fft_out);
+}
+
+void fft_bin_bank_accumulate(fft_bin_bank_t *bank, const kiss_fft_cpx *fft_out) {
+  fft_bin_bank_accumulate_scaled(bank, fft_out, FFT_SCALE_MAGNITUDE);
+}
+
+void fft_bin_bank_accumulate_scaled(fft_bin_bank_t *bank, const kiss_fft_cpx *fft_out, fft_scale_t scale) {
+  FFT_PROFILE_BEGIN(FFT_STAGE_BINS);
+  for (int j = 0; j < bank->bin_count; j++) {
+    float value = 0;
+
+    if (scale == FFT_SCALE_FAST_MAGNITUDE) {
+      for (int i = bank->start[j]; i < bank->end[j]; i++) {
+        float m = output_magnitude(fft_out, i);
+        if (m > value) {
+          value = m;
+        }
+      }
+    } else {
+      for (int i = bank->start[j]; i < bank->end[j]; i++) {
+        value += power_at(fft_out, i);
+      }
+      if (scale == FFT_SCALE_MAGNITUDE) {
+        value = sqrtf(value);
+      }
+    }
+    bank->amplitude[j] = value;
+  }
+  FFT_PROFILE_END(FFT_STAGE_BINS);
+}
+
+void fft_process_spectrum(uint8_t *capture_buf, kiss_fft_cpx *fft_out) {
+  kiss_fft_scalar fft_in[NSAMP];
+
+  if (!default_plan_ready()) {
+    memset(fft_out, 0, sizeof(kiss_fft_cpx) * (NSAMP / 2 + 1));
+    return;
+  }
+
+  FFT_PROFILE_BEGIN(FFT_STAGE_WINDOW);
+  float dc = fill_fft_input(capture_buf, fft_in, NSAMP);
+  FFT_PROFILE_END(FFT_STAGE_WINDOW);
+  default_fftr(fft_in, fft_out);
+  remove_window_dc(fft_out, dc, NSAMP);
+}
+
+// fft_process_spectrum over 'count' consecutive frames of NSAMP samples, several frames per vector on x86 hosts
+void fft_process_batch(const uint8_t *frames, int count, kiss_fft_cpx *spectra) {
+  const int bins = NSAMP / 2 + 1;
+#if FFT_BATCH_SIMD
+  int lanes;
+  fft_batch_kernel_t kernel = batch_kernel(&lanes);
+  float dc[FFT_BATCH_MAX_LANES];
+
+  for (int done = 0; done < count; done += lanes) {
+    int n = count - done < lanes ? count - done : lanes;
+    for (int l = 0; l < n; l++) {
+      dc[l] = fill_fft_input(frames + (done + l) * NSAMP, batch_rows + l * NSAMP, NSAMP);
+    }
+    kernel(batch_rows, n, (float *)(spectra + done * bins));
+    for (int l = 0; l < n; l++) {
+      remove_window_dc(spectra + (done + l) * bins, dc[l], NSAMP);
+    }
+  }
+#else
+  for (int i = 0; i < count; i++) {
+    fft_process_spectrum((uint8_t *)frames + i * NSAMP, spectra + i * bins);
+  }
+#endif
+}
+
+// Frames fft_process_batch transforms at once: 16, 8 or 4 on x86 depending on the CPU, otherwise 1
+int fft_batch_lanes() {
+  int lanes;
+  batch_kernel(&lanes);
+  return lanes;
+}
+
+float fft_stage_fill_input(const uint8_t *buffer, kiss_fft_scalar *fft_in) {
+  return fill_fft_input(buffer, fft_in, NSAMP);
+}
+
+void fft_stage_bin_amplitudes(kiss_fft_cpx *fft_out, frequency_bin_t *bins, int bin_count, fft_scale_t scale) {
+  reset_bins(bins, bin_count);
+  compute_bin_amplitudes(fft_out, bins, bin_count, NSAMP, scale);
+}
+
+float fft_bin_frequency(int index) {
+  return index * FFT_BIN_HZ;
+}
+
+float fft_refine_peak(const kiss_fft_cpx *fft_out, int index, fft_peak_method_t method) {
+  float offset = 0;
+
+  if (index < 1 || index >= NSAMP / 2) {
+    return 0;
+  }
+
+  const kiss_fft_cpx *prev = &fft_out[index - 1];
+  const kiss_fft_cpx *peak = &fft_out[index];
+  const kiss_fft_cpx *next = &fft_out[index + 1];
+
+  switch (method) {
+    case FFT_PEAK_PARABOLIC: {
+      float a = sqrtf(power_at(fft_out, index - 1));
+      float b = sqrtf(power_at(fft_out, index));
+      float c = sqrtf(power_at(fft_out, index + 1));
+      float denom = a - 2 * b + c;
+      if (denom != 0) {
+        offset = 0.5f * (a - c) / denom;
+      }
+      break;
+    }
+    case FFT_PEAK_JACOBSEN: {
+      // Re{(X[k-1] - X[k+1]) / (2X[k] - X[k-1] - X[k+1])}
+      float nr = prev->r - next->r;
+      float ni = prev->i - next->i;
+      float dr = 2 * peak->r - prev->r - next->r;
+      float di = 2 * peak->i - prev->i - next->i;
+      float denom = dr * dr + di * di;
+      if (denom != 0) {
+        offset = (nr * dr + ni * di) / denom;
+      }
+      break;
+    }
+    case FFT_PEAK_QUINN: {
+      float denom = power_at(fft_out, index);
+      if (denom == 0) {
+        break;
+      }
+      float ap = (next->r * peak->r + next->i * peak->i) / denom;
+      float am = (prev->r * peak->r + prev->i * peak->i) / denom;
+      float dp = -ap / (1 - ap);
+      float dm = am / (1 - am);
+      offset = (dp > 0 && dm > 0) ? dp : dm;
+      break;
+    }
+  }
+
+  if (offset > 0.5f) {
+    offset = 0.5f;
+  } else if (offset < -0.5f) {
+    offset = -0.5f;
+  }
+  return offset;
+}
+
+bool fft_find_peak(const kiss_fft_cpx *fft_out, int index_min, int index_max, fft_peak_method_t method, fft_peak_t *peak) {
+  float best = 0;
+
+  // The refinement needs a neighbour on both sides
+  if (index_min < 1) {
+    index_min = 1;
+  }
+  if (index_max > NSAMP / 2) {
+    index_max = NSAMP / 2;
+  }
+
+  peak->index = -1;
+  for (int i = index_min; i < index_max; i++) {
+    float power = power_at(fft_out, i);
+    if (power > best) {
+      best = power;
+      peak->index = i;
+    }
+  }
+
+  if (peak->index < 0) {
+    return false;
+  }
+
+  peak->offset = fft_refine_peak(fft_out, peak->index, method);
+  peak->frequency = (peak->index + peak->offset) * FFT_BIN_HZ;
+  peak->magnitude = sqrtf(best);
+  return true;
+}
+
+void fft_stream_init(fft_stream_t *stream, int hop) {
+  memset(stream->history, 0, sizeof(stream->history));
+  stream->pos = 0;
+  stream->filled = 0;
+  stream->hop = hop > 0 ? hop : NSAMP;
+  stream->pending = 0;
+}
+
+bool fft_stream_push(fft_stream_t *stream, const uint8_t *samples, int count) {
+  // Only the last NSAMP samples can ever be analysed
+  if (count > NSAMP) {
+    samples += count - NSAMP;
+    count = NSAMP;
+  }
+
+  int first = NSAMP - stream->pos;
+  if (first > count) {
+    first = count;
+  }
+  memcpy(stream->history + stream->pos, samples, first);
+  memcpy(stream->history, samples + first, count - first);
+
+  stream->pos = (stream->pos + count) % NSAMP;
+  stream->filled = stream->filled + count < NSAMP ? stream->filled + count : NSAMP;
+  stream->pending = stream->pending + count < NSAMP ? stream->pending + count : NSAMP;
+
+  return stream->filled == NSAMP && stream->pending >= stream->hop;
+}
+
+void fft_stream_process(fft_stream_t *stream, frequency_bin_t *bins, int bin_count) {
+  uint8_t window[NSAMP];
+  int tail = NSAMP - stream->pos;
+
+  // Unroll the ring so that the oldest sample comes first
+  memcpy(window, stream->history + stream->pos, tail);
+  memcpy(window + tail, stream->history, stream->pos);
+  stream->pending = 0;
+
+  fft_process(window, bins, bin_count);
+}
+
+void fft_process_q15(uint8_t *capture_buf, frequency_bin_fixed_t *bins, int bin_count) {
+  int16_t fft_in[NSAMP];
+  kiss_fft_q15_cpx fft_out[NSAMP / 2 + 1];
+  uint32_t power[NSAMP / 2];
+
+  if (!plan_q15) {
+    size_t lenmem = sizeof(plan_q15_mem);
+    plan_q15 = kiss_fftr_q15_alloc(NSAMP, false, plan_q15_mem, &lenmem);
+    if (!plan_q15) {
+      fprintf(stderr, "Failed to allocate Q15 FFT configuration\n");
+      return;
+    }
+  }
+
+  // 8-bit samples centred and scaled to Q15, then windowed, in one pass
+  const int16_t *w = current_window()->table_q15;
+  uint32_t sum = 0;
+  for (int i = 0; i < NSAMP; i++) {
+    int32_t x = (capture_buf[i] - 128) * 128;
+    sum += capture_buf[i];
+    fft_in[i] = (int16_t)(w ? (x * w[i]) >> 15 : x);
+  }
+
+  kiss_fftr_q15(plan_q15, fft_in, fft_out);
+
+  // The output is scaled by 1/NSAMP, so the window's DC leakage is too
+  int32_t dc = average_q(sum, NSAMP, 7) - 128 * 128;
+  for (int j = 0; j < current_window()->terms; j++) {
+    fft_out[j].r -= (int16_t)lroundf(dc * window_dc_leak(j));
+  }
+
+  for (int i = 0; i < NSAMP / 2; i++) {
+    power[i] = (uint32_t)(fft_out[i].r * fft_out[i].r) + (uint32_t)(fft_out[i].i * fft_out[i].i);
+  }
+  sum_bin_energy(power, bins, bin_count);
+}
+
+void fft_process_q31(uint8_t *capture_buf, frequency_bin_fixed_t *bins, int bin_count) {
+  int32_t fft_in[NSAMP];
+  kiss_fft_q31_cpx fft_out[NSAMP / 2 + 1];
+  uint32_t power[NSAMP / 2];
+
+  if (!plan_q31) {
+    size_t lenmem = sizeof(plan_q31_mem);
+    plan_q31 = kiss_fftr_q31_alloc(NSAMP, false, plan_q31_mem, &lenmem);
+    if (!plan_q31) {
+      fprintf(stderr, "Failed to allocate Q31 FFT configuration\n");
+      return;
+    }
+  }
+
+  // Centred and scaled to Q31 (8-bit sample << 23), then windowed, in one pass
+  const int16_t *w = current_window()->table_q15;
+  uint32_t sum = 0;
+  for (int i = 0; i < NSAMP; i++) {
+    int32_t x = capture_buf[i] - 128;
+    sum += capture_buf[i];
+    fft_in[i] = w ? (x * w[i]) * 256 : x * 8388608;
+  }
+
+  kiss_fftr_q31(plan_q31, fft_in, fft_out);
+
+  int32_t dc = (average_q(sum, NSAMP, 8) - 128 * 256) * 32768;
+  for (int j = 0; j < current_window()->terms; j++) {
+    fft_out[j].r -= (int32_t)llround((double)dc * window_dc_leak(j));
+  }
+
+  // Squares are shifted down by 32 bits to land in the same Q15^2 units as the Q15 path
+  for (int i = 0; i < NSAMP / 2; i++) {
+    uint64_t p = (uint64_t)((int64_t)fft_out[i].r * fft_out[i].r) + (uint64_t)((int64_t)fft_out[i].i * fft_out[i].i);
+    power[i] = (uint32_t)(p >> 32);
+  }
+  sum_bin_energy(power, bins, bin_count);
+}
+
+// The specialised kernel needs no plan; otherwise the plan is built once into static memory
+static bool default_plan_ready() {
+#if FFT_STATIC_KERNEL
+  return true;
+#else
+  if (default_plan.cfg) {
+    return true;
+  }
+
+  size_t lenmem = sizeof(default_plan_mem);
+  if (!fft_plan_create(&default_plan, NSAMP, false, default_plan_mem, &lenmem)) {
+    fprintf(stderr, "Failed to allocate FFT configuration\n");
+    return false;
+  }
+  return true;
+#endif
+}
+
+static void default_fftr(const kiss_fft_scalar *fft_in, kiss_fft_cpx *fft_out) {
+  FFT_PROFILE_BEGIN(FFT_STAGE_FFT);
+#if FFT_STATIC_KERNEL
+  fft_kernel_fftr(fft_in, fft_out);
+#else
+  kiss_fftr(default_plan.cfg, fft_in, fft_out);
+#endif
+  FFT_PROFILE_END(FFT_STAGE_FFT);
 }
 
 static void calculate_frequencies() {
-  float f_max = FSAMP;
-  float f_res = 1.0f;
+  float f_res = FFT_BIN_HZ;
   for (int i = 0; i < NSAMP; i++) {
     freqs[i] = f_res * i;
   }
 }
 
-static float calculate_average(uint8_t *buffer, int size) {
-  uint64_t sum = 0;
-  for (int i = 0; i < size; i++) {
-    sum += buffer[i];
+static const fft_window_info_t *current_window() {
+  if (!active_window) {
+    active_window = fft_window_get(FFT_WINDOW_RECT);
+  }
+  return active_window;
+}
+
+// Centres on the ADC midpoint and windows in a single pass; returns the DC still left in the samples
+static float fill_fft_input(const uint8_t *buffer, kiss_fft_scalar *fft_in, int size) {
+  const float *w = current_window()->table;
+  uint32_t sum = 0;
+
+  if (w) {
+    for (int i = 0; i < size; i++) {
+      sum += buffer[i];
+      fft_in[i] = ((int)buffer[i] - 128) * w[i];
+    }
+  } else {
+    for (int i = 0; i < size; i++) {
+      sum += buffer[i];
+      fft_in[i] = (int)buffer[i] - 128;
+    }
   }
-  return (float)sum / size;
+  return (float)sum / size - 128;
 }
 
-static void fill_fft_input(uint8_t *buffer, kiss_fft_scalar *fft_in, int size) {
-  float avg = calculate_average(buffer, size);
-  for (int i = 0; i < size; i++) {
-    fft_in[i] = (float)buffer[i] - avg;
+// Output term 'term' of a unit DC through the window, divided by the FFT size
+static float window_dc_leak(int term) {
+  float a = current_window()->a[term];
+  if (term > 0) {
+    a *= 0.5f;
   }
+  return (term & 1) ? -a : a;
+}
+
+// A windowed constant only reaches the first 'terms' outputs, so the mean can be removed after the FFT
+static void remove_window_dc(kiss_fft_cpx *fft_out, float dc, int size) {
+  for (int j = 0; j < current_window()->terms; j++) {
+    fft_out[j].r -= dc * size * window_dc_leak(j);
+  }
+}
+
+// The widest batch kernel this CPU runs; SSE2 is part of x86-64
+static fft_batch_kernel_t batch_kernel(int *lanes) {
+#if FFT_BATCH_SIMD
+  if (__builtin_cpu_supports("avx512f")) {
+    *lanes = 16;
+    return fft_batch_kernel_v16;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    *lanes = 8;
+    return fft_batch_kernel_v8;
+  }
+  *lanes = 4;
+  return fft_batch_kernel_v4;
+#else
+  *lanes = 1;
+  return NULL;
+#endif
 }
 
 static void reset_bins(frequency_bin_t *bins, int bin_count) {
@@ -103,20 +598,98 @@ static void reset_bins(frequency_bin_t *bins, int bin_count) {
   }
 }
 
-static void compute_bin_amplitudes(kiss_fft_cpx *fft_out, frequency_bin_t *bins, int bin_count, int nsamp) {
+static void compute_bin_amplitudes(kiss_fft_cpx *fft_out, frequency_bin_t *bins, int bin_count, int nsamp, fft_scale_t scale) {
   for (int i = 0; i < nsamp / 2; i++) {
-    float power = fft_out[i].r * fft_out[i].r + fft_out[i].i * fft_out[i].i;
     float freq = freqs[i];
 
     for (int j = 0; j < bin_count; j++) {
       if (freq >= bins[j].freq_min && freq < bins[j].freq_max) {
-        bins[j].amplitude += power;
+        if (scale == FFT_SCALE_FAST_MAGNITUDE) {
+          float m = output_magnitude(fft_out, i);
+          if (m > bins[j].amplitude) {
+            bins[j].amplitude = m;
+          }
+        } else {
+          bins[j].amplitude += power_at(fft_out, i);
+        }
         break;
       }
     }
   }
 
-  for (int i = 0; i < bin_count; i++) {
-    bins[i].amplitude = sqrtf(bins[i].amplitude);
+  if (scale == FFT_SCALE_MAGNITUDE) {
+    for (int i = 0; i < bin_count; i++) {
+      bins[i].amplitude = sqrtf(bins[i].amplitude);
+    }
+  }
+}
+
+// |X| as alpha * max(|re|, |im|) + beta * min(|re|, |im|), at most 4% off
+static float output_magnitude(const kiss_fft_cpx *fft_out, int index) {
+  float re = fabsf(fft_out[index].r);
+  float im = fabsf(fft_out[index].i);
+  float hi = re > im ? re : im;
+  float lo = re > im ? im : re;
+  return 0.96043387f * hi + 0.39782473f * lo;
+}
+
+static void build_db_table() {
+  float octave = 10.0f * log10f(2.0f) / FFT_DB8_STEP_DB;
+
+  // Centre of each mantissa slice, with the floor folded in
+  for (int i = 0; i < 32; i++) {
+    float steps = octave * log2f(1.0f + (i + 0.5f) / 32.0f) - FFT_DB8_FLOOR_DB / FFT_DB8_STEP_DB;
+    db_table[i] = (int16_t)lroundf(steps * 256.0f);
+  }
+  db_octave = (int32_t)lroundf(octave * 256.0f);
+}
+
+// First FFT index whose frequency is at or above freq, NSAMP / 2 if there is none
+static int first_index_from(float freq) {
+  int lo = 0;
+  int hi = NSAMP / 2;
+
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (freqs[mid] >= freq) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return lo;
+}
+
+static float power_at(const kiss_fft_cpx *fft_out, int index) {
+  return fft_out[index].r * fft_out[index].r + fft_out[index].i * fft_out[index].i;
+}
+
+static int32_t average_q(uint32_t sum, int size, int frac_bits) {
+  return (int32_t)((((uint64_t)sum << frac_bits) + size / 2) / size);
+}
+
+// First output at or above hz, as first_index_from but in integer arithmetic for the fixed-point paths
+static int index_from_hz(int hz) {
+  if (hz <= 0) {
+    return 0;
+  }
+  if (hz >= FSAMP / 2) {
+    hz = FSAMP / 2;
+  }
+  int index = (hz * NSAMP + FSAMP - 1) / FSAMP;
+  return index > NSAMP / 2 ? NSAMP / 2 : index;
+}
+
+// Each bin sums its own output range; claimed outputs are zeroed, so as in compute_bin_amplitudes only the first bin counts them
+static void sum_bin_energy(uint32_t *power, frequency_bin_fixed_t *bins, int bin_count) {
+  for (int j = 0; j < bin_count; j++) {
+    int end = index_from_hz(bins[j].freq_max);
+    uint64_t energy = 0;
+
+    for (int i = index_from_hz(bins[j].freq_min); i < end; i++) {
+      energy += power[i];
+      power[i] = 0;
+    }
+    bins[j].energy = energy;
   }
 }
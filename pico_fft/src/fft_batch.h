@@ -0,0 +1,28 @@
+#ifndef FFT_BATCH_H
+#define FFT_BATCH_H
+
+/*
+ * Batch kernels behind fft_process_batch(): kiss_fftr built on 4, 8 and 16
+ * lane float vectors (fft_batch_v4.c, _v8.c, _v16.c), each lane carrying one
+ * frame. They only exist on x86 hosts; the RP2040 build goes frame by frame.
+ */
+
+#include "pico/fft_config.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FFT_BATCH_SIMD 1
+#else
+#define FFT_BATCH_SIMD 0
+#endif
+
+#define FFT_BATCH_MAX_LANES 16
+
+/* Transforms 'count' (up to the kernel's lane count) rows of NSAMP windowed
+   samples into NSAMP/2+1 interleaved complex outputs each */
+typedef void (*fft_batch_kernel_t)(const float *rows, int count, float *spectra);
+
+void fft_batch_kernel_v4(const float *rows, int count, float *spectra);
+void fft_batch_kernel_v8(const float *rows, int count, float *spectra);
+void fft_batch_kernel_v16(const float *rows, int count, float *spectra);
+
+#endif /* FFT_BATCH_H */
@@ -0,0 +1,42 @@
+/*
+ * Body of the batch kernels. Define KISS_FFT_LANES, KISS_FFT_SUFFIX and
+ * FFT_BATCH_KERNEL before including it. The lanes run exactly the scalar
+ * kiss_fftr arithmetic, so each frame comes out bit-identical to it. That
+ * rules out FMA contraction, which AVX-512 would otherwise bring in.
+ */
+
+#pragma GCC optimize("fp-contract=off")
+
+#include "kiss_fft_rename.h"
+#include "kiss_fft.c"
+#include "kiss_fftr.c"
+#include "fft_batch.h"
+
+static kiss_fftr_cfg batch_plan;
+static kiss_fft_scalar batch_in[NSAMP];
+static kiss_fft_cpx batch_out[NSAMP / 2 + 1];
+
+void FFT_BATCH_KERNEL(const float *rows, int count, float *spectra) {
+  const int bins = NSAMP / 2 + 1;
+
+  if (!batch_plan && !(batch_plan = kiss_fftr_alloc(NSAMP, 0, NULL, NULL))) {
+    fprintf(stderr, "Failed to allocate batch FFT configuration\n");
+    return;
+  }
+
+  // Unused lanes keep whatever they held; their outputs are never read
+  for (int i = 0; i < NSAMP; i++) {
+    for (int lane = 0; lane < count; lane++) {
+      batch_in[i][lane] = rows[lane * NSAMP + i];
+    }
+  }
+
+  kiss_fftr(batch_plan, batch_in, batch_out);
+
+  for (int k = 0; k < bins; k++) {
+    for (int lane = 0; lane < count; lane++) {
+      spectra[2 * (lane * bins + k)] = batch_out[k].r[lane];
+      spectra[2 * (lane * bins + k) + 1] = batch_out[k].i[lane];
+    }
+  }
+}
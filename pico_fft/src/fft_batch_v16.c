@@ -0,0 +1,14 @@
+/*
+ * AVX-512 batch kernel: 16 frames per vector, see fft_batch.h.
+ */
+
+#include "fft_batch.h"
+
+#if FFT_BATCH_SIMD
+#pragma GCC target("avx512f")
+
+#define KISS_FFT_LANES 16
+#define KISS_FFT_SUFFIX v16
+#define FFT_BATCH_KERNEL fft_batch_kernel_v16
+#include "fft_batch_lanes.h"
+#endif
@@ -0,0 +1,14 @@
+/*
+ * SSE batch kernel: 4 frames per vector, see fft_batch.h.
+ */
+
+#include "fft_batch.h"
+
+#if FFT_BATCH_SIMD
+#pragma GCC target("sse2")
+
+#define KISS_FFT_LANES 4
+#define KISS_FFT_SUFFIX v4
+#define FFT_BATCH_KERNEL fft_batch_kernel_v4
+#include "fft_batch_lanes.h"
+#endif
@@ -0,0 +1,14 @@
+/*
+ * AVX2 batch kernel: 8 frames per vector, see fft_batch.h.
+ */
+
+#include "fft_batch.h"
+
+#if FFT_BATCH_SIMD
+#pragma GCC target("avx2")
+
+#define KISS_FFT_LANES 8
+#define KISS_FFT_SUFFIX v8
+#define FFT_BATCH_KERNEL fft_batch_kernel_v8
+#include "fft_batch_lanes.h"
+#endif
@@ -0,0 +1,108 @@
+#include "pico/fft_capture.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const fft_capture_hal_t *hal;
+static uint8_t *capture_bufs[2];
+static bool running;
+
+// Only touched with the HAL lock held or from fft_capture_complete()
+static volatile int ready_index = -1;
+static volatile int held_index = -1;
+static volatile bool held_overwritten;
+static fft_capture_stats_t stats;
+
+void fft_capture_set_hal(const fft_capture_hal_t *capture_hal) {
+  hal = capture_hal;
+}
+
+bool fft_capture_start(uint8_t *buf_a, uint8_t *buf_b, int count) {
+  if (running) {
+    fft_capture_stop();
+  }
+  if (!hal) {
+    hal = fft_capture_platform_hal();
+  }
+
+  capture_bufs[0] = buf_a;
+  capture_bufs[1] = buf_b;
+  ready_index = -1;
+  held_index = -1;
+  held_overwritten = false;
+  memset(&stats, 0, sizeof(stats));
+
+  running = hal->start(buf_a, buf_b, count);
+  if (!running) {
+    fprintf(stderr, "Failed to start continuous capture\n");
+  }
+  return running;
+}
+
+void fft_capture_stop(void) {
+  if (running) {
+    hal->stop();
+    running = false;
+  }
+}
+
+uint8_t *fft_capture_acquire(void) {
+  uint8_t *buf = NULL;
+
+  if (!running) {
+    return NULL;
+  }
+
+  uint32_t state = hal->lock();
+  if (ready_index >= 0 && held_index < 0) {
+    held_index = ready_index;
+    ready_index = -1;
+    held_overwritten = false;
+    buf = capture_bufs[held_index];
+  }
+  hal->unlock(state);
+
+  return buf;
+}
+
+bool fft_capture_release(uint8_t *buf) {
+  bool intact;
+
+  if (!running) {
+    return false;
+  }
+
+  uint32_t state = hal->lock();
+  intact = held_index >= 0 && capture_bufs[held_index] == buf && !held_overwritten;
+  if (held_overwritten) {
+    stats.overruns++;
+  }
+  held_index = -1;
+  hal->unlock(state);
+
+  return intact;
+}
+
+void fft_capture_get_stats(fft_capture_stats_t *out) {
+  if (!hal) {
+    memset(out, 0, sizeof(*out));
+    return;
+  }
+  uint32_t state = hal->lock();
+  *out = stats;
+  hal->unlock(state);
+}
+
+void fft_capture_complete(int index) {
+  stats.frames++;
+
+  // The hardware has moved on to the other buffer, so whatever was ready is gone
+  if (ready_index >= 0) {
+    stats.dropped++;
+  }
+  ready_index = index;
+
+  if (held_index == 1 - index) {
+    held_overwritten = true;
+  }
+}
@@ -0,0 +1,92 @@
+#include "pico/fft.h"
+#include "pico/fft_capture.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+
+static int dma_chans[2] = {-1, -1};
+static uint8_t *dma_bufs[2];
+static bool handler_installed;
+
+static void dma_handler() {
+  for (int i = 0; i < 2; i++) {
+    if (dma_channel_get_irq0_status(dma_chans[i])) {
+      dma_channel_acknowledge_irq0(dma_chans[i]);
+      // Re-arm without triggering, the other channel chains back to this one
+      dma_channel_set_write_addr(dma_chans[i], dma_bufs[i], false);
+      fft_capture_complete(i);
+    }
+  }
+}
+
+static bool pico_capture_start(uint8_t *buf_a, uint8_t *buf_b, int count) {
+  dma_bufs[0] = buf_a;
+  dma_bufs[1] = buf_b;
+
+  for (int i = 0; i < 2; i++) {
+    if (dma_chans[i] == -1) {
+      dma_chans[i] = dma_claim_unused_channel(false);
+    }
+    if (dma_chans[i] == -1) {
+      fprintf(stderr, "Failed to claim unused DMA channel\n");
+      return false;
+    }
+  }
+
+  for (int i = 0; i < 2; i++) {
+    dma_channel_config chan_cfg = dma_channel_get_default_config(dma_chans[i]);
+    channel_config_set_transfer_data_size(&chan_cfg, DMA_SIZE_8);
+    channel_config_set_read_increment(&chan_cfg, false);
+    channel_config_set_write_increment(&chan_cfg, true);
+    channel_config_set_dreq(&chan_cfg, DREQ_ADC);
+    channel_config_set_chain_to(&chan_cfg, dma_chans[1 - i]);
+
+    dma_channel_configure(dma_chans[i], &chan_cfg,
+      dma_bufs[i],    // dst
+      &adc_hw->fifo,  // src
+      count,          // transfer count, reloaded on every chain trigger
+      false           // started below
+    );
+    dma_channel_set_irq0_enabled(dma_chans[i], true);
+  }
+
+  if (!handler_installed) {
+    irq_add_shared_handler(DMA_IRQ_0, dma_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    handler_installed = true;
+  }
+  irq_set_enabled(DMA_IRQ_0, true);
+
+  adc_run(false);
+  adc_fifo_drain();
+  dma_channel_start(dma_chans[0]);
+  adc_run(true);
+  return true;
+}
+
+static void pico_capture_stop(void) {
+  adc_run(false);
+  for (int i = 0; i < 2; i++) {
+    dma_channel_set_irq0_enabled(dma_chans[i], false);
+    dma_channel_abort(dma_chans[i]);
+    dma_channel_acknowledge_irq0(dma_chans[i]);
+  }
+  adc_fifo_drain();
+}
+
+static uint32_t pico_capture_lock(void) {
+  return save_and_disable_interrupts();
+}
+
+static void pico_capture_unlock(uint32_t state) {
+  restore_interrupts(state);
+}
+
+static const fft_capture_hal_t pico_capture_hal = {
+  .start = pico_capture_start,
+  .stop = pico_capture_stop,
+  .lock = pico_capture_lock,
+  .unlock = pico_capture_unlock,
+};
+
+const fft_capture_hal_t *fft_capture_platform_hal(void) {
+  return &pico_capture_hal;
+}
@@ -0,0 +1,59 @@
+#ifndef FFT_CONSTEXPR_H
+#define FFT_CONSTEXPR_H
+
+/* Compile-time trigonometry for the C++ table generators */
+
+namespace fft_constexpr {
+
+constexpr double pi = 3.141592653589793238462643383279502884;
+
+// cos(2 pi num / den), reduced exactly in integers before the Taylor series
+constexpr double cos_ratio(long long num, long long den) {
+    long long k = num % den;
+    if (k < 0) {
+        k += den;
+    }
+    double x = 2 * pi * k / den;
+    if (x > pi) {
+        x -= 2 * pi;
+    }
+
+    double term = 1;
+    double sum = 1;
+    for (int i = 1; i < 40; i++) {
+        term *= -x * x / ((2 * i - 1) * (2 * i));
+        sum += term;
+    }
+    return sum;
+}
+
+// sin(2 pi num / den)
+constexpr double sin_ratio(long long num, long long den) {
+    // sin(t) = cos(t - pi / 2), with the quarter turn kept exact
+    return cos_ratio(4 * num - den, 4 * den);
+}
+
+// kiss_fft_alloc's twiddles for an n-point complex FFT: exp(-+2 pi i k / n)
+template <typename Cpx>
+constexpr void kiss_twiddles(Cpx *tw, int n, bool inverse) {
+    using scalar = decltype(tw->r);
+    for (int k = 0; k < n; k++) {
+        tw[k].r = (scalar)cos_ratio(k, n);
+        tw[k].i = (scalar)(inverse ? sin_ratio(k, n) : sin_ratio(-k, n));
+    }
+}
+
+// kiss_fftr_alloc's super twiddles for a real FFT of 2 * ncfft points: exp(-+i pi ((k + 1) / ncfft + 1/2))
+template <typename Cpx>
+constexpr void kiss_super_twiddles(Cpx *tw, int ncfft, bool inverse) {
+    using scalar = decltype(tw->r);
+    for (int k = 0; k < ncfft / 2; k++) {
+        long long num = 2LL * (k + 1) + ncfft;
+        tw[k].r = (scalar)cos_ratio(num, 4LL * ncfft);
+        tw[k].i = (scalar)(inverse ? sin_ratio(num, 4LL * ncfft) : sin_ratio(-num, 4LL * ncfft));
+    }
+}
+
+}  // namespace fft_constexpr
+
+#endif /* FFT_CONSTEXPR_H */
@@ -0,0 +1,165 @@
+#include "pico/fft_decimate.h"
+
+// Compensator passband and stopband edge as fractions of the CIC output rate
+#define FIR_PASS 0.2
+#define FIR_STOP 0.3
+#define FIR_GRID 512
+
+static double cic_response(double x, int factor);
+static void design_compensator(fft_decimator_t *dec);
+static int32_t cic_step(fft_decimator_t *dec, int32_t x, bool *ready);
+static int16_t fir_output(const fft_decimator_t *dec);
+
+bool fft_decimator_init(fft_decimator_t *dec, int cic_factor) {
+  if (cic_factor < 1 || cic_factor > FFT_CIC_MAX_FACTOR || (cic_factor & (cic_factor - 1))) {
+    fprintf(stderr, "CIC factor must be a power of two up to %d\n", FFT_CIC_MAX_FACTOR);
+    return false;
+  }
+
+  dec->cic_factor = cic_factor;
+  dec->cic_shift = 0;
+  while ((1 << dec->cic_shift) < cic_factor) {
+    dec->cic_shift++;
+  }
+  dec->cic_shift *= FFT_CIC_ORDER;
+
+  design_compensator(dec);
+  fft_decimator_reset(dec);
+  return true;
+}
+
+void fft_decimator_reset(fft_decimator_t *dec) {
+  memset(dec->integ, 0, sizeof(dec->integ));
+  memset(dec->comb, 0, sizeof(dec->comb));
+  memset(dec->history, 0, sizeof(dec->history));
+  dec->cic_phase = 0;
+  dec->hpos = 0;
+  dec->fir_phase = 0;
+}
+
+// Consumes count ADC samples and returns how many decimated samples were written to out
+int fft_decimate(fft_decimator_t *dec, const uint8_t *in, int count, int16_t *out) {
+  int produced = 0;
+
+  for (int i = 0; i < count; i++) {
+    bool ready;
+    int32_t y = cic_step(dec, (int32_t)in[i] - 128, &ready);
+    if (!ready) {
+      continue;
+    }
+
+    // Normalise the CIC gain and move to FFT_DECIM_FRAC_BITS; y reaches 2^27 at the largest factor, so in 64 bits
+    y = (int32_t)(((int64_t)y * (1 << FFT_DECIM_FRAC_BITS)) >> dec->cic_shift);
+    dec->history[dec->hpos] = y;
+    dec->history[dec->hpos + FFT_DECIM_TAPS] = y;
+    if (++dec->hpos == FFT_DECIM_TAPS) {
+      dec->hpos = 0;
+    }
+
+    dec->fir_phase ^= 1;
+    if (!dec->fir_phase) {
+      out[produced++] = fir_output(dec);
+    }
+  }
+  return produced;
+}
+
+// Real FFT of plan->nfft decimated samples, DC removed; magnitudes are in 8-bit ADC units like fft_process_spectrum
+void fft_decimated_spectrum(const fft_plan_t *plan, const int16_t *samples, kiss_fft_cpx *fft_out) {
+  kiss_fft_scalar fft_in[NSAMP];
+  int64_t sum = 0;
+
+  if (plan->nfft > NSAMP) {
+    fprintf(stderr, "Decimated FFT larger than NSAMP\n");
+    return;
+  }
+
+  for (int i = 0; i < plan->nfft; i++) {
+    sum += samples[i];
+  }
+  float avg = (float)sum / plan->nfft;
+  for (int i = 0; i < plan->nfft; i++) {
+    fft_in[i] = (samples[i] - avg) * (1.0f / (1 << FFT_DECIM_FRAC_BITS));
+  }
+  kiss_fftr(plan->cfg, fft_in, fft_out);
+}
+
+// Normalised magnitude response of the CIC at x cycles per CIC output sample
+static double cic_response(double x, int factor) {
+  if (x == 0) {
+    return 1.0;
+  }
+  double h = sin(M_PI * x) / (factor * sin(M_PI * x / factor));
+  return pow(fabs(h), FFT_CIC_ORDER);
+}
+
+// Frequency-sampling design: inverse CIC droop up to FIR_PASS, tapering to zero at FIR_STOP, Hamming windowed
+static void design_compensator(fft_decimator_t *dec) {
+  double h[FFT_DECIM_TAPS];
+  double sum = 0;
+  int mid = FFT_DECIM_TAPS / 2;
+
+  for (int n = 0; n < FFT_DECIM_TAPS; n++) {
+    double acc = 0;
+    for (int k = 0; k < FIR_GRID; k++) {
+      double x = (k + 0.5) * 0.5 / FIR_GRID;
+      double d;
+      if (x <= FIR_PASS) {
+        d = 1.0 / cic_response(x, dec->cic_factor);
+      } else if (x < FIR_STOP) {
+        d = (FIR_STOP - x) / (FIR_STOP - FIR_PASS) / cic_response(FIR_PASS, dec->cic_factor);
+      } else {
+        d = 0;
+      }
+      acc += d * cos(2 * M_PI * x * (n - mid));
+    }
+    double window = 0.54 - 0.46 * cos(2 * M_PI * n / (FFT_DECIM_TAPS - 1));
+    h[n] = acc * window;
+    sum += h[n];
+  }
+
+  // Unity gain at DC
+  for (int n = 0; n < FFT_DECIM_TAPS; n++) {
+    dec->taps[n] = (int16_t)lround(h[n] / sum * 32768.0);
+  }
+}
+
+static int32_t cic_step(fft_decimator_t *dec, int32_t x, bool *ready) {
+  uint32_t v = (uint32_t)x;
+
+  for (int s = 0; s < FFT_CIC_ORDER; s++) {
+    dec->integ[s] += v;
+    v = dec->integ[s];
+  }
+
+  if (++dec->cic_phase < dec->cic_factor) {
+    *ready = false;
+    return 0;
+  }
+  dec->cic_phase = 0;
+
+  for (int s = 0; s < FFT_CIC_ORDER; s++) {
+    uint32_t prev = dec->comb[s];
+    dec->comb[s] = v;
+    v -= prev;
+  }
+  *ready = true;
+  return (int32_t)v;
+}
+
+static int16_t fir_output(const fft_decimator_t *dec) {
+  // history[hpos .. hpos + FFT_DECIM_TAPS) holds the oldest to newest sample
+  const int32_t *x = &dec->history[dec->hpos];
+  int32_t acc = 0;
+
+  for (int n = 0; n < FFT_DECIM_TAPS; n++) {
+    acc += dec->taps[n] * x[n];
+  }
+  acc = (acc + (1 << 14)) >> 15;
+  if (acc > INT16_MAX) {
+    acc = INT16_MAX;
+  } else if (acc < INT16_MIN) {
+    acc = INT16_MIN;
+  }
+  return (int16_t)acc;
+}
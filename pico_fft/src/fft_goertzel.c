@@ -0,0 +1,105 @@
+#include "pico/fft_goertzel.h"
+
+// Fractional bits of the samples fed to the fixed-point filters
+#define SAMPLE_FRAC_BITS 4
+
+static uint32_t sum_samples(const uint8_t *samples, int count);
+
+void fft_goertzel_init(fft_goertzel_bank_t *bank) {
+  bank->count = 0;
+}
+
+// Adds freq plus 'neighbours' targets cents_step apart on either side; returns the index of freq
+int fft_goertzel_add(fft_goertzel_bank_t *bank, float freq, float cents_step, int neighbours) {
+  if (bank->count + 2 * neighbours + 1 > FFT_GOERTZEL_MAX_TARGETS) {
+    fprintf(stderr, "Goertzel bank is full\n");
+    return -1;
+  }
+
+  for (int n = -neighbours; n <= neighbours; n++) {
+    int i = bank->count++;
+    float f = freq * powf(2.0f, n * cents_step / 1200.0f);
+    double coeff = 2.0 * cos(2.0 * M_PI * f / FSAMP);
+
+    bank->freq[i] = f;
+    bank->coeff[i] = (float)coeff;
+    bank->coeff_q29[i] = (int32_t)lround(coeff * (1 << 29));
+    bank->power[i] = 0;
+  }
+  return bank->count - neighbours - 1;
+}
+
+void fft_goertzel_process(fft_goertzel_bank_t *bank, const uint8_t *samples, int count) {
+  float avg = (float)sum_samples(samples, count) / count;
+
+  for (int t = 0; t < bank->count; t++) {
+    float coeff = bank->coeff[t];
+    float s1 = 0;
+    float s2 = 0;
+
+    for (int i = 0; i < count; i++) {
+      float s0 = (samples[i] - avg) + coeff * s1 - s2;
+      s2 = s1;
+      s1 = s0;
+    }
+    bank->power[t] = s1 * s1 + s2 * s2 - coeff * s1 * s2;
+  }
+}
+
+void fft_goertzel_process_fixed(fft_goertzel_bank_t *bank, const uint8_t *samples, int count) {
+  int32_t avg = (int32_t)((((uint64_t)sum_samples(samples, count) << SAMPLE_FRAC_BITS) + count / 2) / count);
+
+  for (int t = 0; t < bank->count; t++) {
+    int32_t coeff = bank->coeff_q29[t];
+    int32_t s1 = 0;
+    int32_t s2 = 0;
+
+    for (int i = 0; i < count; i++) {
+      int32_t x = (samples[i] << SAMPLE_FRAC_BITS) - avg;
+      int32_t s0 = x + (int32_t)(((int64_t)coeff * s1) >> 29) - s2;
+      s2 = s1;
+      s1 = s0;
+    }
+
+    // The final combination runs once per target, so float is fine here
+    float f1 = (float)s1 / (1 << SAMPLE_FRAC_BITS);
+    float f2 = (float)s2 / (1 << SAMPLE_FRAC_BITS);
+    bank->power[t] = f1 * f1 + f2 * f2 - bank->coeff[t] * f1 * f2;
+  }
+}
+
+// Index of the strongest target in [first, first + count)
+int fft_goertzel_peak(const fft_goertzel_bank_t *bank, int first, int count) {
+  int best = first;
+  for (int i = first + 1; i < first + count; i++) {
+    if (bank->power[i] > bank->power[best]) {
+      best = i;
+    }
+  }
+  return best;
+}
+
+// Parabolic interpolation between neighbouring targets of one evenly spaced (in cents) group
+float fft_goertzel_refine(const fft_goertzel_bank_t *bank, int index, int first, int count) {
+  if (index <= first || index >= first + count - 1) {
+    return bank->freq[index];
+  }
+
+  float a = sqrtf(bank->power[index - 1]);
+  float b = sqrtf(bank->power[index]);
+  float c = sqrtf(bank->power[index + 1]);
+  float denom = a - 2 * b + c;
+  float offset = denom != 0 ? 0.5f * (a - c) / denom : 0;
+
+  // The grid is geometric, so interpolate the exponent
+  float ratio = bank->freq[index + 1] / bank->freq[index];
+  return bank->freq[index] * powf(ratio, offset);
+}
+
+static uint32_t sum_samples(const uint8_t *samples, int count) {
+  uint32_t sum = 0;
+  for (int i = 0; i < count; i++) {
+    sum += samples[i];
+  }
+  return sum;
+}
@@ -0,0 +1,270 @@
+#include "pico/fft_kernel.h"
+#include "pico/_kiss_fft_guts.h"
+#include "fft_constexpr.h"
+
+namespace {
+
+static_assert(NSAMP % 2 == 0, "the real FFT packs NSAMP / 2 complex points");
+
+constexpr int ncfft = NSAMP / 2;
+
+struct factor_list {
+    int count;
+    int p[MAXFACTORS];
+    int m[MAXFACTORS];
+};
+
+// Same order as kf_factor(): powers of 4, then 2, then odd primes
+constexpr factor_list factorize(int n) {
+    factor_list f{};
+    int floor_sqrt = 0;
+    while ((floor_sqrt + 1) * (floor_sqrt + 1) <= n) {
+        floor_sqrt++;
+    }
+
+    int p = 4;
+    do {
+        while (n % p) {
+            p = p == 4 ? 2 : p == 2 ? 3 : p + 2;
+            if (p > floor_sqrt) {
+                p = n;
+            }
+        }
+        n /= p;
+        f.p[f.count] = p;
+        f.m[f.count] = n;
+        f.count++;
+    } while (n > 1);
+    return f;
+}
+
+constexpr factor_list factors = factorize(ncfft);
+
+struct twiddle_tables {
+    kiss_fft_cpx twiddles[ncfft];
+    kiss_fft_cpx super_twiddles[ncfft / 2];
+};
+
+constexpr twiddle_tables make_tables() {
+    twiddle_tables t{};
+    fft_constexpr::kiss_twiddles(t.twiddles, ncfft, false);
+    fft_constexpr::kiss_super_twiddles(t.super_twiddles, ncfft, false);
+    return t;
+}
+
+constexpr twiddle_tables tables = make_tables();
+constexpr const kiss_fft_cpx *twiddles = tables.twiddles;
+
+template <int M, int Fstride>
+void bfly2(kiss_fft_cpx *Fout) {
+    const kiss_fft_cpx *tw1 = twiddles;
+    kiss_fft_cpx *Fout2 = Fout + M;
+    kiss_fft_cpx t;
+
+    for (int k = 0; k < M; k++) {
+        C_MUL(t, *Fout2, *tw1);
+        tw1 += Fstride;
+        C_SUB(*Fout2, *Fout, t);
+        C_ADDTO(*Fout, t);
+        ++Fout2;
+        ++Fout;
+    }
+}
+
+template <int M, int Fstride>
+void bfly3(kiss_fft_cpx *Fout) {
+    const kiss_fft_cpx *tw1 = twiddles;
+    const kiss_fft_cpx *tw2 = twiddles;
+    constexpr kiss_fft_cpx epi3 = twiddles[Fstride * M];
+    kiss_fft_cpx scratch[5];
+
+    for (int k = 0; k < M; k++) {
+        C_MUL(scratch[1], Fout[M], *tw1);
+        C_MUL(scratch[2], Fout[2 * M], *tw2);
+
+        C_ADD(scratch[3], scratch[1], scratch[2]);
+        C_SUB(scratch[0], scratch[1], scratch[2]);
+        tw1 += Fstride;
+        tw2 += Fstride * 2;
+
+        Fout[M].r = Fout->r - HALF_OF(scratch[3].r);
+        Fout[M].i = Fout->i - HALF_OF(scratch[3].i);
+
+        C_MULBYSCALAR(scratch[0], epi3.i);
+
+        C_ADDTO(*Fout, scratch[3]);
+
+        Fout[2 * M].r = Fout[M].r + scratch[0].i;
+        Fout[2 * M].i = Fout[M].i - scratch[0].r;
+
+        Fout[M].r -= scratch[0].i;
+        Fout[M].i += scratch[0].r;
+
+        ++Fout;
+    }
+}
+
+template <int M, int Fstride>
+void bfly4(kiss_fft_cpx *Fout) {
+    const kiss_fft_cpx *tw1 = twiddles;
+    const kiss_fft_cpx *tw2 = twiddles;
+    const kiss_fft_cpx *tw3 = twiddles;
+    kiss_fft_cpx scratch[6];
+
+    for (int k = 0; k < M; k++) {
+        C_MUL(scratch[0], Fout[M], *tw1);
+        C_MUL(scratch[1], Fout[2 * M], *tw2);
+        C_MUL(scratch[2], Fout[3 * M], *tw3);
+
+        C_SUB(scratch[5], *Fout, scratch[1]);
+        C_ADDTO(*Fout, scratch[1]);
+        C_ADD(scratch[3], scratch[0], scratch[2]);
+        C_SUB(scratch[4], scratch[0], scratch[2]);
+        C_SUB(Fout[2 * M], *Fout, scratch[3]);
+        tw1 += Fstride;
+        tw2 += Fstride * 2;
+        tw3 += Fstride * 3;
+        C_ADDTO(*Fout, scratch[3]);
+
+        Fout[M].r = scratch[5].r + scratch[4].i;
+        Fout[M].i = scratch[5].i - scratch[4].r;
+        Fout[3 * M].r = scratch[5].r - scratch[4].i;
+        Fout[3 * M].i = scratch[5].i + scratch[4].r;
+        ++Fout;
+    }
+}
+
+template <int M, int Fstride>
+void bfly5(kiss_fft_cpx *Fout) {
+    constexpr kiss_fft_cpx ya = twiddles[Fstride * M];
+    constexpr kiss_fft_cpx yb = twiddles[Fstride * 2 * M];
+    const kiss_fft_cpx *tw = twiddles;
+    kiss_fft_cpx *Fout0 = Fout;
+    kiss_fft_cpx *Fout1 = Fout0 + M;
+    kiss_fft_cpx *Fout2 = Fout0 + 2 * M;
+    kiss_fft_cpx *Fout3 = Fout0 + 3 * M;
+    kiss_fft_cpx *Fout4 = Fout0 + 4 * M;
+    kiss_fft_cpx scratch[13];
+
+    for (int u = 0; u < M; ++u) {
+        scratch[0] = *Fout0;
+
+        C_MUL(scratch[1], *Fout1, tw[u * Fstride]);
+        C_MUL(scratch[2], *Fout2, tw[2 * u * Fstride]);
+        C_MUL(scratch[3], *Fout3, tw[3 * u * Fstride]);
+        C_MUL(scratch[4], *Fout4, tw[4 * u * Fstride]);
+
+        C_ADD(scratch[7], scratch[1], scratch[4]);
+        C_SUB(scratch[10], scratch[1], scratch[4]);
+        C_ADD(scratch[8], scratch[2], scratch[3]);
+        C_SUB(scratch[9], scratch[2], scratch[3]);
+
+        Fout0->r += scratch[7].r + scratch[8].r;
+        Fout0->i += scratch[7].i + scratch[8].i;
+
+        scratch[5].r = scratch[0].r + S_MUL(scratch[7].r, ya.r) + S_MUL(scratch[8].r, yb.r);
+        scratch[5].i = scratch[0].i + S_MUL(scratch[7].i, ya.r) + S_MUL(scratch[8].i, yb.r);
+
+        scratch[6].r = S_MUL(scratch[10].i, ya.i) + S_MUL(scratch[9].i, yb.i);
+        scratch[6].i = -S_MUL(scratch[10].r, ya.i) - S_MUL(scratch[9].r, yb.i);
+
+        C_SUB(*Fout1, scratch[5], scratch[6]);
+        C_ADD(*Fout4, scratch[5], scratch[6]);
+
+        scratch[11].r = scratch[0].r + S_MUL(scratch[7].r, yb.r) + S_MUL(scratch[8].r, ya.r);
+        scratch[11].i = scratch[0].i + S_MUL(scratch[7].i, yb.r) + S_MUL(scratch[8].i, ya.r);
+        scratch[12].r = -S_MUL(scratch[10].i, yb.i) + S_MUL(scratch[9].i, ya.i);
+        scratch[12].i = S_MUL(scratch[10].r, yb.i) - S_MUL(scratch[9].r, ya.i);
+
+        C_ADD(*Fout2, scratch[11], scratch[12]);
+        C_SUB(*Fout3, scratch[11], scratch[12]);
+
+        ++Fout0; ++Fout1; ++Fout2; ++Fout3; ++Fout4;
+    }
+}
+
+template <int P, int M, int Fstride>
+void bfly_generic(kiss_fft_cpx *Fout) {
+    kiss_fft_cpx scratch[P];
+    kiss_fft_cpx t;
+
+    for (int u = 0; u < M; ++u) {
+        for (int q1 = 0, k = u; q1 < P; ++q1, k += M) {
+            scratch[q1] = Fout[k];
+        }
+
+        for (int q1 = 0, k = u; q1 < P; ++q1, k += M) {
+            int twidx = 0;
+            Fout[k] = scratch[0];
+            for (int q = 1; q < P; ++q) {
+                twidx += Fstride * k;
+                if (twidx >= ncfft) {
+                    twidx -= ncfft;
+                }
+                C_MUL(t, scratch[q], twiddles[twidx]);
+                C_ADDTO(Fout[k], t);
+            }
+        }
+    }
+}
+
+// One level of kf_work() with the radix, sub-length and stride fixed at compile time
+template <int Level>
+void work(kiss_fft_cpx *Fout, const kiss_fft_cpx *f) {
+    constexpr int p = factors.p[Level];
+    constexpr int m = factors.m[Level];
+    constexpr int fstride = ncfft / (p * m);
+
+    if constexpr (m == 1) {
+        for (int q = 0; q < p; q++) {
+            Fout[q] = f[q * fstride];
+        }
+    } else {
+        for (int q = 0; q < p; q++) {
+            work<Level + 1>(Fout + q * m, f + q * fstride);
+        }
+    }
+
+    if constexpr (p == 2) {
+        bfly2<m, fstride>(Fout);
+    } else if constexpr (p == 3) {
+        bfly3<m, fstride>(Fout);
+    } else if constexpr (p == 4) {
+        bfly4<m, fstride>(Fout);
+    } else if constexpr (p == 5) {
+        bfly5<m, fstride>(Fout);
+    } else {
+        bfly_generic<p, m, fstride>(Fout);
+    }
+}
+
+}  // namespace
+
+extern "C" void fft_kernel_fftr(const kiss_fft_scalar *timedata, kiss_fft_cpx *freqdata) {
+    kiss_fft_cpx fpnk, fpk, f1k, f2k, tw, tdc;
+
+    // The complex FFT goes straight to freqdata: each split step reads and writes only
+    // outputs k and ncfft - k, so no scratch is needed and concurrent calls do not share state
+    work<0>(freqdata, (const kiss_fft_cpx *)timedata);
+
+    tdc.r = freqdata[0].r;
+    tdc.i = freqdata[0].i;
+    freqdata[0].r = tdc.r + tdc.i;
+    freqdata[ncfft].r = tdc.r - tdc.i;
+    freqdata[ncfft].i = freqdata[0].i = 0;
+
+    for (int k = 1; k <= ncfft / 2; ++k) {
+        fpk = freqdata[k];
+        fpnk.r = freqdata[ncfft - k].r;
+        fpnk.i = -freqdata[ncfft - k].i;
+
+        C_ADD(f1k, fpk, fpnk);
+        C_SUB(f2k, fpk, fpnk);
+        C_MUL(tw, f2k, tables.super_twiddles[k - 1]);
+
+        freqdata[k].r = HALF_OF(f1k.r + tw.r);
+        freqdata[k].i = HALF_OF(f1k.i + tw.i);
+        freqdata[ncfft - k].r = HALF_OF(f1k.r - tw.r);
+        freqdata[ncfft - k].i = HALF_OF(tw.i - f1k.i);
+    }
+}
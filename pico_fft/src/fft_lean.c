@@ -0,0 +1,184 @@
+#include "pico/fft_lean.h"
+
+static float unclaimed_power(const fft_lean_t *lean, const float *buf, const frequency_bin_t *bins, int bin, int lo,
+                             int hi, int from);
+static int index_from(const fft_lean_t *lean, float freq);
+static kiss_fft_cpx packed_at(const float *buf, int nfft, int k);
+static size_t align8(size_t size);
+
+bool fft_lean_init(fft_lean_t *lean, int nfft, fft_window_t window, void *mem, size_t *lenmem) {
+  const fft_twiddle_table_t *table = fft_twiddle_table_find(nfft, false);
+  int ncfft = nfft / 2;
+  size_t cfg_len = 0;
+
+  if (nfft & 1) {
+    fprintf(stderr, "Lean FFT size must be even\n");
+    return false;
+  }
+  if (table) {
+    kiss_fft_alloc_static(ncfft, 0, table->twiddles, NULL, &cfg_len);
+  } else {
+    kiss_fft_alloc(ncfft, 0, NULL, &cfg_len);
+  }
+  cfg_len = align8(cfg_len);
+  size_t memneeded = cfg_len + (table ? 0 : sizeof(kiss_fft_cpx) * (ncfft / 2));
+
+  if (!mem || *lenmem < memneeded) {
+    *lenmem = memneeded;
+    return false;
+  }
+  *lenmem = memneeded;
+
+  lean->nfft = nfft;
+  lean->window = fft_window_get(window);
+  if (table) {
+    lean->cfg = kiss_fft_alloc_static(ncfft, 0, table->twiddles, mem, &cfg_len);
+    lean->super_twiddles = table->super_twiddles;
+    return true;
+  }
+
+  lean->cfg = kiss_fft_alloc(ncfft, 0, mem, &cfg_len);
+  kiss_fft_cpx *super_twiddles = (kiss_fft_cpx *)((char *)mem + cfg_len);
+  for (int i = 0; i < ncfft / 2; i++) {
+    // As kiss_fftr_alloc computes them
+    double phase = -3.14159265358979323846264338327 * ((double)(i + 1) / ncfft + .5);
+    super_twiddles[i].r = (kiss_fft_scalar)cos(phase);
+    super_twiddles[i].i = (kiss_fft_scalar)sin(phase);
+  }
+  lean->super_twiddles = super_twiddles;
+  return true;
+}
+
+// nfft real samples in, the packed spectrum out, with kiss_fftr's arithmetic throughout
+void fft_lean_forward(const fft_lean_t *lean, float *buf) {
+  kiss_fft_cpx *z = (kiss_fft_cpx *)buf;
+  int ncfft = lean->nfft / 2;
+
+  kiss_fft(lean->cfg, z, z);
+
+  // Each step reads and writes only outputs k and ncfft - k, so the split works in place
+  kiss_fft_cpx tdc = z[0];
+  z[0].r = tdc.r + tdc.i;
+  z[0].i = tdc.r - tdc.i;
+
+  for (int k = 1; k <= ncfft / 2; k++) {
+    kiss_fft_cpx fpk = z[k];
+    kiss_fft_cpx fpnk = {z[ncfft - k].r, -z[ncfft - k].i};
+    kiss_fft_cpx f1k = {fpk.r + fpnk.r, fpk.i + fpnk.i};
+    kiss_fft_cpx f2k = {fpk.r - fpnk.r, fpk.i - fpnk.i};
+    kiss_fft_cpx tw = lean->super_twiddles[k - 1];
+    float tw_r = f2k.r * tw.r - f2k.i * tw.i;
+    float tw_i = f2k.r * tw.i + f2k.i * tw.r;
+
+    z[k].r = (f1k.r + tw_r) * .5f;
+    z[k].i = (f1k.i + tw_i) * .5f;
+    z[ncfft - k].r = (f1k.r - tw_r) * .5f;
+    z[ncfft - k].i = (tw_i - f1k.i) * .5f;
+  }
+}
+
+// Bin amplitudes like fft_process, for lean->nfft samples transformed in 'buf'
+void fft_lean_process(const fft_lean_t *lean, const uint8_t *samples, float *buf, frequency_bin_t *bins, int bin_count) {
+  for (int i = 0; i < lean->nfft; i++) {
+    buf[i] = (int)samples[i] - 128;
+  }
+  fft_lean_forward(lean, buf);
+  // Dropping X[0] removes the mean exactly, before the window spreads it
+  buf[0] = 0;
+
+  // As compute_bin_amplitudes: an output in several bins only counts in the first
+  for (int j = 0; j < bin_count; j++) {
+    int lo = index_from(lean, bins[j].freq_min);
+    int hi = index_from(lean, bins[j].freq_max);
+    bins[j].amplitude = sqrtf(unclaimed_power(lean, buf, bins, j, lo, hi, 0));
+  }
+}
+
+// Windowed output k of the packed spectrum: a0 X[k] + sum_j (-1)^j a_j/2 (X[k - j] + X[k + j])
+kiss_fft_cpx fft_lean_output(const fft_lean_t *lean, const float *buf, int k) {
+  const fft_window_info_t *w = lean->window;
+  kiss_fft_cpx x = packed_at(buf, lean->nfft, k);
+
+  x.r *= w->a[0];
+  x.i *= w->a[0];
+  for (int j = 1; j < w->terms; j++) {
+    kiss_fft_cpx lo = packed_at(buf, lean->nfft, k - j);
+    kiss_fft_cpx hi = packed_at(buf, lean->nfft, k + j);
+    float a = (j & 1) ? -0.5f * w->a[j] : 0.5f * w->a[j];
+    x.r += a * (lo.r + hi.r);
+    x.i += a * (lo.i + hi.i);
+  }
+  return x;
+}
+
+float fft_lean_bin_frequency(const fft_lean_t *lean, int k) {
+  return (float)k * FSAMP / lean->nfft;
+}
+
+// Power of outputs lo to hi - 1 that none of bins[from .. bin - 1] already holds
+static float unclaimed_power(const fft_lean_t *lean, const float *buf, const frequency_bin_t *bins, int bin, int lo,
+                             int hi, int from) {
+  float power = 0;
+
+  if (lo >= hi) {
+    return 0;
+  }
+  for (int i = from; i < bin; i++) {
+    // Compared as frequencies first, so that only overlapping bins cost a search
+    if (bins[i].freq_min >= bins[i].freq_max || fft_lean_bin_frequency(lean, lo) >= bins[i].freq_max ||
+        fft_lean_bin_frequency(lean, hi - 1) < bins[i].freq_min) {
+      continue;
+    }
+    int start = index_from(lean, bins[i].freq_min);
+    int end = index_from(lean, bins[i].freq_max);
+    return unclaimed_power(lean, buf, bins, bin, lo, start, i + 1) +
+           unclaimed_power(lean, buf, bins, bin, end, hi, i + 1);
+  }
+
+  for (int k = lo; k < hi; k++) {
+    kiss_fft_cpx x = fft_lean_output(lean, buf, k);
+    power += x.r * x.r + x.i * x.i;
+  }
+  return power;
+}
+
+// First output whose frequency is at or above freq, nfft / 2 if there is none
+static int index_from(const fft_lean_t *lean, float freq) {
+  int lo = 0;
+  int hi = lean->nfft / 2;
+
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (fft_lean_bin_frequency(lean, mid) >= freq) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return lo;
+}
+
+// X[k] for any k, from the half spectrum and X[-k] = X[nfft - k] = conj(X[k])
+static kiss_fft_cpx packed_at(const float *buf, int nfft, int k) {
+  kiss_fft_cpx x;
+  k %= nfft;
+  if (k < 0) {
+    k += nfft;
+  }
+  bool mirrored = k > nfft / 2;
+  if (mirrored) {
+    k = nfft - k;
+  }
+  if (k == 0 || k == nfft / 2) {
+    x.r = buf[k ? 1 : 0];
+    x.i = 0;
+    return x;
+  }
+  x.r = buf[2 * k];
+  x.i = mirrored ? -buf[2 * k + 1] : buf[2 * k + 1];
+  return x;
+}
+
+static size_t align8(size_t size) {
+  return (size + 7) & ~(size_t)7;
+}
@@ -0,0 +1,146 @@
+#include "pico/fft_pitch.h"
+
+#define PITCH_NFFT (2 * FFT_PITCH_NSAMP)
+
+static fft_plan_t forward_plan;
+static fft_plan_t inverse_plan;
+static uint64_t forward_plan_mem[(FFT_PLAN_STATIC_MEM_SIZE(PITCH_NFFT) + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+static uint64_t inverse_plan_mem[(FFT_PLAN_STATIC_MEM_SIZE(PITCH_NFFT) + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+static kiss_fft_scalar time_buf[PITCH_NFFT];
+static kiss_fft_cpx freq_buf[PITCH_NFFT / 2 + 1];
+
+static bool create_plans();
+static float calculate_average(const uint8_t *samples, int size);
+static void compute_nsdf(const uint8_t *samples, float avg, float *nsdf, int max_lag);
+static bool pick_period(const float *nsdf, int min_lag, int max_lag, float *period, float *clarity);
+
+bool fft_pitch_detect(const uint8_t *samples, fft_pitch_t *pitch) {
+  int min_lag = (int)(FSAMP / FFT_PITCH_MAX_HZ);
+  int max_lag = (int)(FSAMP / FFT_PITCH_MIN_HZ) + 1;
+  float period;
+
+  pitch->frequency = 0;
+  pitch->clarity = 0;
+
+  if (max_lag >= FFT_PITCH_NSAMP) {
+    max_lag = FFT_PITCH_NSAMP - 1;
+  }
+  if (!forward_plan.cfg && !create_plans()) {
+    return false;
+  }
+
+  float avg = calculate_average(samples, FFT_PITCH_NSAMP);
+  compute_nsdf(samples, avg, time_buf, max_lag);
+
+  if (!pick_period(time_buf, min_lag, max_lag, &period, &pitch->clarity)) {
+    return false;
+  }
+  pitch->frequency = FSAMP / period;
+  return true;
+}
+
+static bool create_plans() {
+  size_t forward_len = sizeof(forward_plan_mem);
+  size_t inverse_len = sizeof(inverse_plan_mem);
+
+  if (!fft_plan_create(&forward_plan, PITCH_NFFT, false, forward_plan_mem, &forward_len) ||
+      !fft_plan_create(&inverse_plan, PITCH_NFFT, true, inverse_plan_mem, &inverse_len)) {
+    fprintf(stderr, "Failed to allocate pitch FFT configuration\n");
+    forward_plan.cfg = NULL;
+    return false;
+  }
+  return true;
+}
+
+static float calculate_average(const uint8_t *samples, int size) {
+  uint32_t sum = 0;
+  for (int i = 0; i < size; i++) {
+    sum += samples[i];
+  }
+  return (float)sum / size;
+}
+
+// nsdf[tau] = 2 r(tau) / m(tau) for tau <= max_lag, written over the autocorrelation
+static void compute_nsdf(const uint8_t *samples, float avg, float *nsdf, int max_lag) {
+  const int n = FFT_PITCH_NSAMP;
+
+  // Zero padding to twice the window keeps the correlation linear
+  for (int i = 0; i < n; i++) {
+    time_buf[i] = samples[i] - avg;
+  }
+  memset(time_buf + n, 0, sizeof(kiss_fft_scalar) * n);
+
+  kiss_fftr(forward_plan.cfg, time_buf, freq_buf);
+  for (int k = 0; k <= PITCH_NFFT / 2; k++) {
+    freq_buf[k].r = freq_buf[k].r * freq_buf[k].r + freq_buf[k].i * freq_buf[k].i;
+    freq_buf[k].i = 0;
+  }
+  kiss_fftri(inverse_plan.cfg, freq_buf, time_buf);
+
+  // m(tau) = sum of x[j]^2 + x[j + tau]^2 over the overlap, updated as the overlap shrinks.
+  // The autocorrelation comes back scaled by PITCH_NFFT, which cancels against m.
+  float m = 0;
+  for (int i = 0; i < n; i++) {
+    float x = samples[i] - avg;
+    m += 2 * x * x;
+  }
+  m *= PITCH_NFFT;
+
+  for (int tau = 0; tau <= max_lag; tau++) {
+    if (tau > 0) {
+      float head = samples[tau - 1] - avg;
+      float tail = samples[n - tau] - avg;
+      m -= (head * head + tail * tail) * PITCH_NFFT;
+    }
+    nsdf[tau] = m > 0 ? 2 * time_buf[tau] / m : 0;
+  }
+}
+
+// Picks the first key maximum within FFT_PITCH_CUTOFF of the highest one
+static bool pick_period(const float *nsdf, int min_lag, int max_lag, float *period, float *clarity) {
+  int peaks[32];
+  int peak_count = 0;
+  float highest = 0;
+  int tau = 1;
+
+  // Skip the lobe around zero lag
+  while (tau < max_lag && nsdf[tau] > 0) {
+    tau++;
+  }
+
+  // One key maximum per positive lobe
+  while (tau < max_lag && peak_count < 32) {
+    while (tau < max_lag && nsdf[tau] <= 0) {
+      tau++;
+    }
+    int best = -1;
+    while (tau < max_lag && nsdf[tau] > 0) {
+      if (best < 0 || nsdf[tau] > nsdf[best]) {
+        best = tau;
+      }
+      tau++;
+    }
+    if (best >= min_lag && best < max_lag) {
+      peaks[peak_count++] = best;
+      if (nsdf[best] > highest) {
+        highest = nsdf[best];
+      }
+    }
+  }
+
+  for (int i = 0; i < peak_count; i++) {
+    int k = peaks[i];
+    if (nsdf[k] >= FFT_PITCH_CUTOFF * highest) {
+      float a = nsdf[k - 1];
+      float b = nsdf[k];
+      float c = nsdf[k + 1];
+      float denom = a - 2 * b + c;
+      float offset = denom != 0 ? 0.5f * (a - c) / denom : 0;
+
+      *period = k + offset;
+      *clarity = b - 0.25f * (a - c) * offset;
+      return true;
+    }
+  }
+  return false;
+}
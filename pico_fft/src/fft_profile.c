@@ -0,0 +1,156 @@
+#include "pico/fft_profile.h"
+
+#include <stdatomic.h>
+#include <string.h>
+#if PICO_ON_DEVICE
+#include <malloc.h>
+
+#define STACK_MARK 0x5aa5c33cu
+#define STACK_MARGIN_WORDS 64  // left unmarked below fft_profile_init()'s own frame
+
+// Both stacks as placed by the SDK's linker scripts
+extern uint32_t __StackBottom, __StackTop, __StackOneBottom, __StackOneTop;
+#endif
+
+static fft_profile_stats_t stats[FFT_STAGE_COUNT];
+static atomic_bool reset_pending[FFT_STAGE_COUNT];  // set by fft_profile_reset(), applied by the recording core
+static const fft_profile_stats_t empty_stats = {.min_us = UINT32_MAX};
+static uint32_t last_print_us;
+
+static const char *const stage_names[FFT_STAGE_COUNT] = {
+  "capture", "window", "fft", "bins", "detect", "print", "stream", "display", "frame",
+};
+
+static void clear_stats(fft_profile_stats_t *s);
+static int bucket_of(uint32_t us);
+#if PICO_ON_DEVICE
+static uint32_t stack_used(const uint32_t *bottom, const uint32_t *top);
+#endif
+
+void fft_profile_init(void) {
+#if PICO_ON_DEVICE
+  // Marked in place rather than in a helper, whose frame would lie in the area being marked
+  volatile uint32_t here = 0;
+  for (uint32_t *p = &__StackBottom; p < (uint32_t *)&here - STACK_MARGIN_WORDS; p++) {
+    *p = STACK_MARK;
+  }
+  for (uint32_t *p = &__StackOneBottom; p < &__StackOneTop; p++) {
+    *p = STACK_MARK;
+  }
+#endif
+  for (int s = 0; s < FFT_STAGE_COUNT; s++) {
+    clear_stats(&stats[s]);
+    atomic_init(&reset_pending[s], false);
+  }
+  last_print_us = time_us_32();
+}
+
+// Only requests the reset: each stage is cleared by the core that records it, so no core writes another's stats
+void fft_profile_reset(void) {
+  for (int s = 0; s < FFT_STAGE_COUNT; s++) {
+    atomic_store_explicit(&reset_pending[s], true, memory_order_release);
+  }
+  last_print_us = time_us_32();
+}
+
+void fft_profile_record(fft_stage_t stage, uint32_t us) {
+  fft_profile_stats_t *s = &stats[stage];
+
+  if (atomic_load_explicit(&reset_pending[stage], memory_order_acquire)) {
+    clear_stats(s);
+    atomic_store_explicit(&reset_pending[stage], false, memory_order_release);
+  }
+  s->count++;
+  s->total_us += us;
+  if (us < s->min_us) {
+    s->min_us = us;
+  }
+  if (us > s->max_us) {
+    s->max_us = us;
+  }
+  s->histogram[bucket_of(us)]++;
+}
+
+// A stage whose reset is still pending reads as empty
+const fft_profile_stats_t *fft_profile_stats(fft_stage_t stage) {
+  if (atomic_load_explicit(&reset_pending[stage], memory_order_acquire)) {
+    return &empty_stats;
+  }
+  return &stats[stage];
+}
+
+const char *fft_profile_stage_name(fft_stage_t stage) {
+  return stage_names[stage];
+}
+
+void fft_profile_memory(fft_profile_memory_t *mem) {
+  memset(mem, 0, sizeof(*mem));
+#if PICO_ON_DEVICE
+  struct mallinfo info = mallinfo();
+  mem->heap_used = info.uordblks;
+  mem->heap_peak = info.arena;  // newlib only grows the arena
+  mem->stack_size[0] = (&__StackTop - &__StackBottom) * sizeof(uint32_t);
+  mem->stack_size[1] = (&__StackOneTop - &__StackOneBottom) * sizeof(uint32_t);
+  mem->stack_peak[0] = stack_used(&__StackBottom, &__StackTop);
+  mem->stack_peak[1] = stack_used(&__StackOneBottom, &__StackOneTop);
+#endif
+}
+
+void fft_profile_print(void) {
+  fft_profile_memory_t mem;
+
+  printf("stage        count      min      avg      max  histogram (us:count)\n");
+  for (int i = 0; i < FFT_STAGE_COUNT; i++) {
+    const fft_profile_stats_t *s = fft_profile_stats(i);
+    if (s->count == 0) {
+      continue;
+    }
+    printf("%-8s %9lu %8lu %8lu %8lu ", stage_names[i], (unsigned long)s->count, (unsigned long)s->min_us,
+           (unsigned long)(s->total_us / s->count), (unsigned long)s->max_us);
+    for (int b = 0; b < FFT_PROFILE_BUCKETS; b++) {
+      if (s->histogram[b]) {
+        printf(" %s%lu:%lu", b == FFT_PROFILE_BUCKETS - 1 ? ">=" : "", b ? 1ul << (b - 1) : 0ul,
+               (unsigned long)s->histogram[b]);
+      }
+    }
+    printf("\n");
+  }
+
+  fft_profile_memory(&mem);
+  if (mem.stack_size[0] == 0) {
+    return;
+  }
+  printf("heap %lu used, %lu peak; stack core0 %lu/%lu, core1 %lu/%lu\n", (unsigned long)mem.heap_used,
+         (unsigned long)mem.heap_peak, (unsigned long)mem.stack_peak[0], (unsigned long)mem.stack_size[0],
+         (unsigned long)mem.stack_peak[1], (unsigned long)mem.stack_size[1]);
+}
+
+bool fft_profile_print_every(uint32_t period_ms) {
+  if (time_us_32() - last_print_us < period_ms * 1000u) {
+    return false;
+  }
+  fft_profile_print();
+  fft_profile_reset();
+  return true;
+}
+
+static void clear_stats(fft_profile_stats_t *s) {
+  memset(s, 0, sizeof(*s));
+  s->min_us = UINT32_MAX;
+}
+
+static int bucket_of(uint32_t us) {
+  int bucket = us ? 32 - __builtin_clz(us) : 0;
+  return bucket < FFT_PROFILE_BUCKETS ? bucket : FFT_PROFILE_BUCKETS - 1;
+}
+
+#if PICO_ON_DEVICE
+// Bytes from the deepest overwritten mark to the top
+static uint32_t stack_used(const uint32_t *bottom, const uint32_t *top) {
+  const uint32_t *p = bottom;
+  while (p < top && *p == STACK_MARK) {
+    p++;
+  }
+  return (top - p) * sizeof(uint32_t);
+}
+#endif
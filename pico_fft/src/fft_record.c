@@ -0,0 +1,104 @@
+#include "pico/fft_record.h"
+#include <stdio.h>
+#include <string.h>
+
+static size_t spectrum_offset(int frame_samples);
+
+void fft_record_header_init(fft_record_header_t *header, uint32_t sample_rate, int frame_samples, int sample_bits,
+                            uint8_t flags, int spectrum_count, float first_hz, float step_hz) {
+  memset(header, 0, sizeof(*header));
+  memcpy(header->magic, FFT_RECORD_MAGIC, sizeof(header->magic));
+  header->version = FFT_RECORD_VERSION;
+  header->header_size = sizeof(*header);
+  header->sample_rate = sample_rate;
+  header->frame_samples = frame_samples;
+  header->sample_bits = sample_bits;
+  header->flags = flags;
+  if (flags & FFT_RECORD_SPECTRUM) {
+    header->spectrum_count = spectrum_count;
+    header->spectrum_first_hz = first_hz;
+    header->spectrum_step_hz = step_hz;
+  }
+  header->frame_size = fft_record_frame_size(frame_samples, header->spectrum_count);
+}
+
+size_t fft_record_frame_size(int frame_samples, int spectrum_count) {
+  return (spectrum_offset(frame_samples) + sizeof(float) * spectrum_count + 7) & ~(size_t)7;
+}
+
+// Fills one frame_size record; spectrum may be NULL without FFT_RECORD_SPECTRUM
+void fft_record_pack(const fft_record_header_t *header, void *record, uint64_t time_us, const uint8_t *samples,
+                     const float *spectrum, float pitch_hz, float clarity) {
+  fft_record_frame_t *frame = record;
+  uint8_t *bytes = record;
+
+  memset(record, 0, header->frame_size);
+  frame->time_us = time_us;
+  if (header->flags & FFT_RECORD_PITCH) {
+    frame->pitch_hz = pitch_hz;
+    frame->clarity = clarity;
+  }
+  memcpy(bytes + sizeof(*frame), samples, header->frame_samples);
+  if (spectrum && header->spectrum_count) {
+    memcpy(bytes + spectrum_offset(header->frame_samples), spectrum, sizeof(float) * header->spectrum_count);
+  }
+}
+
+// Checks the header against the data; a truncated last frame is left out
+bool fft_record_open(fft_recording_t *rec, const void *data, size_t size) {
+  const fft_record_header_t *header = data;
+
+  if (size < sizeof(*header)) {
+    fprintf(stderr, "FFT recording shorter than its header (%zu bytes)\n", size);
+    return false;
+  }
+  if (memcmp(header->magic, FFT_RECORD_MAGIC, sizeof(header->magic)) != 0) {
+    fprintf(stderr, "Not an FFT recording\n");
+    return false;
+  }
+  if (header->version != FFT_RECORD_VERSION) {
+    fprintf(stderr, "Unsupported FFT recording version %u\n", header->version);
+    return false;
+  }
+  if (header->header_size < sizeof(*header) || header->header_size > size) {
+    fprintf(stderr, "Bad FFT recording header size %u\n", header->header_size);
+    return false;
+  }
+  if (header->frame_size < fft_record_frame_size(header->frame_samples, header->spectrum_count)) {
+    fprintf(stderr, "FFT recording frame size %u too small for %u samples and %u spectrum values\n",
+            header->frame_size, header->frame_samples, header->spectrum_count);
+    return false;
+  }
+
+  uint32_t available = (size - header->header_size) / header->frame_size;
+  rec->header = header;
+  rec->frames = (const uint8_t *)data + header->header_size;
+  rec->frame_count = header->frame_count && header->frame_count < available ? header->frame_count : available;
+  return true;
+}
+
+const fft_record_frame_t *fft_record_frame(const fft_recording_t *rec, uint32_t index) {
+  if (index >= rec->frame_count) {
+    return NULL;
+  }
+  return (const fft_record_frame_t *)(rec->frames + (size_t)index * rec->header->frame_size);
+}
+
+// NULL unless the samples are stored one per byte
+const uint8_t *fft_record_samples(const fft_recording_t *rec, const fft_record_frame_t *frame) {
+  if (rec->header->sample_bits == 0 || rec->header->sample_bits > 8) {
+    return NULL;
+  }
+  return (const uint8_t *)(frame + 1);
+}
+
+const float *fft_record_spectrum(const fft_recording_t *rec, const fft_record_frame_t *frame) {
+  if (!(rec->header->flags & FFT_RECORD_SPECTRUM)) {
+    return NULL;
+  }
+  return (const float *)((const uint8_t *)frame + spectrum_offset(rec->header->frame_samples));
+}
+
+static size_t spectrum_offset(int frame_samples) {
+  return (sizeof(fft_record_frame_t) + frame_samples + 3) & ~(size_t)3;
+}
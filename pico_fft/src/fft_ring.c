@@ -0,0 +1,47 @@
+#include "pico/fft_ring.h"
+
+#include <stdio.h>
+
+bool fft_ring_init(fft_ring_t *ring, void *storage, size_t slot_size, uint32_t capacity) {
+  if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+    fprintf(stderr, "Ring capacity must be a power of two\n");
+    return false;
+  }
+
+  ring->slots = storage;
+  ring->slot_size = slot_size;
+  ring->capacity = capacity;
+  atomic_init(&ring->head, 0);
+  atomic_init(&ring->tail, 0);
+  return true;
+}
+
+void *fft_ring_claim(fft_ring_t *ring) {
+  unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  unsigned tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+  if (head - tail == ring->capacity) {
+    return NULL;
+  }
+  return ring->slots + (head & (ring->capacity - 1)) * ring->slot_size;
+}
+
+void fft_ring_publish(fft_ring_t *ring) {
+  unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+void *fft_ring_peek(fft_ring_t *ring) {
+  unsigned tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  unsigned head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+  if (head == tail) {
+    return NULL;
+  }
+  return ring->slots + (tail & (ring->capacity - 1)) * ring->slot_size;
+}
+
+void fft_ring_release(fft_ring_t *ring) {
+  unsigned tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
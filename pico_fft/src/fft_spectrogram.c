@@ -0,0 +1,88 @@
+#include "pico/fft_spectrogram.h"
+
+static uint8_t *next_column(fft_spectrogram_t *sg);
+
+bool fft_spectrogram_init(fft_spectrogram_t *sg, float freq_min, float freq_max, int rows, int columns, void *mem, size_t *lenmem) {
+  size_t memneeded = FFT_SPECTROGRAM_MEM_SIZE(rows, columns);
+  size_t bank_len = FFT_BIN_BANK_MEM_SIZE(rows);
+
+  if (!mem || *lenmem < memneeded) {
+    *lenmem = memneeded;
+    return false;
+  }
+  *lenmem = memneeded;
+
+  sg->rows = rows;
+  sg->columns = columns;
+  sg->head = 0;
+  sg->count = 0;
+  sg->freq_min = freq_min;
+  sg->row_hz = (freq_max - freq_min) / rows;
+
+  // The bank first, with the cells after it
+  fft_bin_bank_init(&sg->bank, NULL, rows, mem, &bank_len);
+  sg->cells = (uint8_t *)mem + bank_len;
+
+  for (int r = 0; r < rows; r++) {
+    fft_bin_bank_set(&sg->bank, r, freq_min + r * sg->row_hz, freq_min + (r + 1) * sg->row_hz);
+    // Rows narrower than an FFT bin still show the output they fall on
+    if (sg->bank.end[r] == sg->bank.start[r] && sg->bank.start[r] < NSAMP / 2) {
+      sg->bank.end[r]++;
+    }
+  }
+  memset(sg->cells, 0, (size_t)rows * columns);
+  return true;
+}
+
+// One frame from fft_process_spectrum's outputs: summed power per row, as dB8 codes
+void fft_spectrogram_append(fft_spectrogram_t *sg, const kiss_fft_cpx *fft_out) {
+  fft_bin_bank_accumulate_scaled(&sg->bank, fft_out, FFT_SCALE_POWER);
+  fft_power_to_db8(sg->bank.amplitude, next_column(sg), sg->rows);
+}
+
+// A column computed elsewhere, e.g. by fft_process_db8 over matching bins
+void fft_spectrogram_append_db8(fft_spectrogram_t *sg, const uint8_t *column) {
+  memcpy(next_column(sg), column, sg->rows);
+}
+
+// 'rows' codes of the frame 'age' frames back (0 is the newest), NULL if it is not held
+const uint8_t *fft_spectrogram_column(const fft_spectrogram_t *sg, int age) {
+  if (age < 0 || age >= sg->count) {
+    return NULL;
+  }
+  int column = sg->head - 1 - age;
+  if (column < 0) {
+    column += sg->columns;
+  }
+  return sg->cells + (size_t)column * sg->rows;
+}
+
+// Copies a row's history into 'out', oldest first; returns the number of frames
+int fft_spectrogram_row(const fft_spectrogram_t *sg, int row, uint8_t *out) {
+  int column = sg->count < sg->columns ? 0 : sg->head;
+
+  for (int i = 0; i < sg->count; i++) {
+    out[i] = sg->cells[(size_t)column * sg->rows + row];
+    if (++column == sg->columns) {
+      column = 0;
+    }
+  }
+  return sg->count;
+}
+
+// Centre of a row's band
+float fft_spectrogram_row_frequency(const fft_spectrogram_t *sg, int row) {
+  return sg->freq_min + (row + 0.5f) * sg->row_hz;
+}
+
+static uint8_t *next_column(fft_spectrogram_t *sg) {
+  uint8_t *column = sg->cells + (size_t)sg->head * sg->rows;
+
+  if (++sg->head == sg->columns) {
+    sg->head = 0;
+  }
+  if (sg->count < sg->columns) {
+    sg->count++;
+  }
+  return column;
+}
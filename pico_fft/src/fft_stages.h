@@ -0,0 +1,16 @@
+#ifndef FFT_STAGES_H
+#define FFT_STAGES_H
+
+/*
+ * The stages of fft_process_scaled() on their own, so bench/fft_bench.c can
+ * time them separately. Not part of the library's interface.
+ */
+
+#include "pico/fft.h"
+
+/* Centres, windows and converts NSAMP samples; returns the mean */
+float fft_stage_fill_input(const uint8_t *buffer, kiss_fft_scalar *fft_in);
+/* Clears the bins and sums the NSAMP/2 outputs into them */
+void fft_stage_bin_amplitudes(kiss_fft_cpx *fft_out, frequency_bin_t *bins, int bin_count, fft_scale_t scale);
+
+#endif /* FFT_STAGES_H */
@@ -0,0 +1,52 @@
+#include "pico/fft_twiddles.h"
+#include "fft_constexpr.h"
+
+namespace {
+
+template <int Nfft>
+struct real_tables {
+    kiss_fft_cpx twiddles[Nfft / 2];
+    kiss_fft_cpx super_twiddles[Nfft / 4];
+};
+
+// What kiss_fftr_alloc(Nfft, inverse) would compute at run time
+template <int Nfft>
+constexpr real_tables<Nfft> make_tables(bool inverse) {
+    real_tables<Nfft> t{};
+    fft_constexpr::kiss_twiddles(t.twiddles, Nfft / 2, inverse);
+    fft_constexpr::kiss_super_twiddles(t.super_twiddles, Nfft / 2, inverse);
+    return t;
+}
+
+constexpr int pitch_nfft = 2 * FFT_PITCH_NSAMP;
+
+constexpr real_tables<pitch_nfft> pitch_forward = make_tables<pitch_nfft>(false);
+constexpr real_tables<pitch_nfft> pitch_inverse = make_tables<pitch_nfft>(true);
+#if !FFT_STATIC_KERNEL
+constexpr real_tables<NSAMP> nsamp_forward = make_tables<NSAMP>(false);
+#endif
+#if FFT_LEAN_NFFT
+constexpr real_tables<FFT_LEAN_NFFT> lean_forward = make_tables<FFT_LEAN_NFFT>(false);
+#endif
+
+const fft_twiddle_table_t tables[] = {
+    {pitch_nfft, false, pitch_forward.twiddles, pitch_forward.super_twiddles},
+    {pitch_nfft, true, pitch_inverse.twiddles, pitch_inverse.super_twiddles},
+#if !FFT_STATIC_KERNEL
+    {NSAMP, false, nsamp_forward.twiddles, nsamp_forward.super_twiddles},
+#endif
+#if FFT_LEAN_NFFT
+    {FFT_LEAN_NFFT, false, lean_forward.twiddles, lean_forward.super_twiddles},
+#endif
+};
+
+}  // namespace
+
+extern "C" const fft_twiddle_table_t *fft_twiddle_table_find(int nfft, bool inverse) {
+    for (const fft_twiddle_table_t &table : tables) {
+        if (table.nfft == nfft && table.inverse == inverse) {
+            return &table;
+        }
+    }
+    return nullptr;
+}
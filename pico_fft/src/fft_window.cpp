@@ -0,0 +1,84 @@
+#include "pico/fft_window.h"
+#include "fft_constexpr.h"
+
+namespace {
+
+struct float_table {
+    float v[NSAMP];
+};
+
+struct q15_table {
+    int16_t v[NSAMP];
+};
+
+struct cosine_sum {
+    int terms;
+    double a[FFT_WINDOW_MAX_TERMS];
+};
+
+constexpr cosine_sum rect = {1, {1.0}};
+constexpr cosine_sum hann = {2, {0.5, 0.5}};
+constexpr cosine_sum blackman_harris = {4, {0.35875, 0.48829, 0.14128, 0.01168}};
+constexpr cosine_sum flat_top = {5, {0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368}};
+
+constexpr double coefficient(const cosine_sum &w, int n) {
+    double sum = 0;
+    for (int j = 0; j < w.terms; j++) {
+        double term = w.a[j] * fft_constexpr::cos_ratio((long long)j * n, NSAMP);
+        sum += (j & 1) ? -term : term;
+    }
+    return sum;
+}
+
+constexpr float_table make_float(const cosine_sum &w) {
+    float_table t{};
+    for (int n = 0; n < NSAMP; n++) {
+        t.v[n] = (float)coefficient(w, n);
+    }
+    return t;
+}
+
+constexpr q15_table make_q15(const cosine_sum &w) {
+    q15_table t{};
+    for (int n = 0; n < NSAMP; n++) {
+        double q = coefficient(w, n) * 32768.0;
+        q = q < 0 ? q - 0.5 : q + 0.5;
+        t.v[n] = q > 32767 ? 32767 : q < -32768 ? -32768 : (int16_t)q;
+    }
+    return t;
+}
+
+constexpr fft_window_info_t make_info(const cosine_sum &w, const float *table, const int16_t *table_q15) {
+    fft_window_info_t info{};
+    info.terms = w.terms;
+    for (int j = 0; j < w.terms; j++) {
+        info.a[j] = (float)w.a[j];
+    }
+    info.table = table;
+    info.table_q15 = table_q15;
+    return info;
+}
+
+// constexpr forces evaluation at compile time, so the tables are constant-initialised into flash
+constexpr float_table hann_table = make_float(hann);
+constexpr q15_table hann_table_q15 = make_q15(hann);
+constexpr float_table blackman_harris_table = make_float(blackman_harris);
+constexpr q15_table blackman_harris_table_q15 = make_q15(blackman_harris);
+constexpr float_table flat_top_table = make_float(flat_top);
+constexpr q15_table flat_top_table_q15 = make_q15(flat_top);
+
+const fft_window_info_t windows[FFT_WINDOW_COUNT] = {
+    make_info(rect, nullptr, nullptr),
+    make_info(hann, hann_table.v, hann_table_q15.v),
+    make_info(blackman_harris, blackman_harris_table.v, blackman_harris_table_q15.v),
+    make_info(flat_top, flat_top_table.v, flat_top_table_q15.v),
+};
+
+}  // namespace
+
+extern "C" const fft_window_info_t *fft_window_get(fft_window_t window) {
+    if (window < 0 || window >= FFT_WINDOW_COUNT) {
+        return &windows[FFT_WINDOW_RECT];
+    }
+    return &windows[window];
+}
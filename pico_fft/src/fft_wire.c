@@ -0,0 +1,464 @@
+#include "pico/fft_wire.h"
+#include <math.h>
+#include <string.h>
+
+#define SPECTRUM_HEAD_SIZE 8
+#define SAMPLES_HEAD_SIZE 8
+#define CHUNK_VALUES 32
+
+enum { WAIT_SYNC0, WAIT_SYNC1, READ_HEAD, READ_PAYLOAD };
+
+static bool process(fft_wire_decoder_t *dec, fft_wire_frame_t *frame);
+static void rescan(fft_wire_decoder_t *dec);
+static uint16_t begin_frame(fft_wire_encoder_t *enc, uint8_t type, size_t length);
+static uint16_t write_part(fft_wire_encoder_t *enc, uint16_t crc, const uint8_t *data, size_t len);
+static void end_frame(fft_wire_encoder_t *enc, uint16_t crc);
+static bool send_bytes(fft_wire_encoder_t *enc, uint8_t type, const uint8_t *head, size_t head_len, const uint8_t *body, int count);
+static size_t delta_encode(const uint8_t *prev, const uint8_t *cur, size_t len, uint8_t *out);
+static void put_spectrum_head(uint8_t *head, float first_hz, float step_hz);
+static bool payload_fits(int count, int value_size, size_t head_len);
+static bool finish_frame(fft_wire_decoder_t *dec, const uint8_t *raw, fft_wire_frame_t *frame);
+static fft_wire_reference_t *reference_for(fft_wire_reference_t *refs, uint8_t type);
+static size_t head_size(uint8_t type);
+static void put_u32(uint8_t *p, uint32_t v);
+static uint32_t get_u32(const uint8_t *p);
+static void put_f32(uint8_t *p, float v);
+static float get_f32(const uint8_t *p);
+
+void fft_wire_init(fft_wire_encoder_t *enc, fft_wire_write_t write, bool delta) {
+  memset(enc, 0, sizeof(*enc));
+  enc->write = write;
+  enc->delta = delta;
+}
+
+bool fft_wire_send_samples(fft_wire_encoder_t *enc, const uint8_t *samples, int count, uint32_t sample_rate, uint32_t time_us) {
+  uint8_t head[SAMPLES_HEAD_SIZE];
+
+  put_u32(head, sample_rate);
+  put_u32(head + 4, time_us);
+  return send_bytes(enc, FFT_WIRE_SAMPLES, head, sizeof(head), samples, count);
+}
+
+bool fft_wire_send_spectrum_f32(fft_wire_encoder_t *enc, const float *power, int count, float first_hz, float step_hz) {
+  uint8_t head[SPECTRUM_HEAD_SIZE];
+  uint8_t chunk[4 * CHUNK_VALUES];
+
+  if (!payload_fits(count, 4, sizeof(head))) {
+    return false;
+  }
+  put_spectrum_head(head, first_hz, step_hz);
+  uint16_t crc = begin_frame(enc, FFT_WIRE_SPECTRUM_F32, sizeof(head) + 4 * (size_t)count);
+  crc = write_part(enc, crc, head, sizeof(head));
+  for (int i = 0; i < count; i += CHUNK_VALUES) {
+    int n = count - i < CHUNK_VALUES ? count - i : CHUNK_VALUES;
+    for (int j = 0; j < n; j++) {
+      put_f32(chunk + 4 * j, power[i + j]);
+    }
+    crc = write_part(enc, crc, chunk, 4 * n);
+  }
+  end_frame(enc, crc);
+  return true;
+}
+
+// Magnitudes relative to a full-scale sine, whose NSAMP-point output is 64 * NSAMP
+bool fft_wire_send_spectrum_q15(fft_wire_encoder_t *enc, const float *power, int count, float first_hz, float step_hz) {
+  const float scale = 32768.0f / (64.0f * NSAMP);
+  uint8_t head[SPECTRUM_HEAD_SIZE];
+  uint8_t chunk[2 * CHUNK_VALUES];
+
+  if (!payload_fits(count, 2, sizeof(head))) {
+    return false;
+  }
+  put_spectrum_head(head, first_hz, step_hz);
+  uint16_t crc = begin_frame(enc, FFT_WIRE_SPECTRUM_Q15, sizeof(head) + 2 * (size_t)count);
+  crc = write_part(enc, crc, head, sizeof(head));
+  for (int i = 0; i < count; i += CHUNK_VALUES) {
+    int n = count - i < CHUNK_VALUES ? count - i : CHUNK_VALUES;
+    for (int j = 0; j < n; j++) {
+      float q = sqrtf(power[i + j]) * scale + 0.5f;
+      uint16_t v = q >= 32767.0f ? 32767 : (uint16_t)q;
+      chunk[2 * j] = v & 0xff;
+      chunk[2 * j + 1] = v >> 8;
+    }
+    crc = write_part(enc, crc, chunk, 2 * n);
+  }
+  end_frame(enc, crc);
+  return true;
+}
+
+bool fft_wire_send_spectrum_db8(fft_wire_encoder_t *enc, const uint8_t *db, int count, float first_hz, float step_hz) {
+  uint8_t head[SPECTRUM_HEAD_SIZE];
+
+  put_spectrum_head(head, first_hz, step_hz);
+  return send_bytes(enc, FFT_WIRE_SPECTRUM_DB8, head, sizeof(head), db, count);
+}
+
+bool fft_wire_send_pitch(fft_wire_encoder_t *enc, float frequency, float clarity, fft_wire_pitch_source_t source) {
+  uint8_t payload[9];
+
+  put_f32(payload, frequency);
+  put_f32(payload + 4, clarity);
+  payload[8] = source;
+  uint16_t crc = begin_frame(enc, FFT_WIRE_PITCH, sizeof(payload));
+  end_frame(enc, write_part(enc, crc, payload, sizeof(payload)));
+  return true;
+}
+
+void fft_wire_decoder_init(fft_wire_decoder_t *dec) {
+  memset(dec, 0, sizeof(*dec));
+  dec->state = WAIT_SYNC0;
+}
+
+// Feeds one received byte; returns true with 'frame' filled when it completes a valid frame
+bool fft_wire_decode(fft_wire_decoder_t *dec, uint8_t byte, fft_wire_frame_t *frame) {
+  if (dec->end == sizeof(dec->buf)) {
+    // The frame being read, and any bytes after it, move to the front
+    memmove(dec->buf, dec->buf + dec->start, dec->end - dec->start);
+    dec->scan -= dec->start;
+    dec->end -= dec->start;
+    dec->start = 0;
+  }
+  dec->buf[dec->end++] = byte;
+  return process(dec, frame);
+}
+
+// At the end of the input: gives up on a partial frame and rescans its bytes; call until it returns false
+bool fft_wire_decode_flush(fft_wire_decoder_t *dec, fft_wire_frame_t *frame) {
+  while (dec->start < dec->end) {
+    if (process(dec, frame)) {
+      return true;
+    }
+    if (dec->start < dec->end) {
+      rescan(dec);
+    }
+  }
+  return false;
+}
+
+bool fft_wire_get_samples(const fft_wire_frame_t *frame, uint32_t *sample_rate, uint32_t *time_us, const uint8_t **samples, int *count) {
+  if (frame->type != FFT_WIRE_SAMPLES || frame->length < SAMPLES_HEAD_SIZE) {
+    return false;
+  }
+  *sample_rate = get_u32(frame->payload);
+  *time_us = get_u32(frame->payload + 4);
+  *samples = frame->payload + SAMPLES_HEAD_SIZE;
+  *count = frame->length - SAMPLES_HEAD_SIZE;
+  return true;
+}
+
+bool fft_wire_get_spectrum(const fft_wire_frame_t *frame, fft_wire_spectrum_t *spectrum) {
+  int size;
+
+  switch (frame->type) {
+  case FFT_WIRE_SPECTRUM_F32: size = 4; break;
+  case FFT_WIRE_SPECTRUM_Q15: size = 2; break;
+  case FFT_WIRE_SPECTRUM_DB8: size = 1; break;
+  default: return false;
+  }
+  if (frame->length < SPECTRUM_HEAD_SIZE) {
+    return false;
+  }
+  spectrum->type = frame->type;
+  spectrum->first_hz = get_f32(frame->payload);
+  spectrum->step_hz = get_f32(frame->payload + 4);
+  spectrum->count = (frame->length - SPECTRUM_HEAD_SIZE) / size;
+  spectrum->values = frame->payload + SPECTRUM_HEAD_SIZE;
+  return true;
+}
+
+// Any of the spectrum formats back to a power comparable with FFT_WIRE_SPECTRUM_F32
+float fft_wire_spectrum_power(const fft_wire_spectrum_t *spectrum, int index) {
+  const uint8_t *v = spectrum->values;
+
+  switch (spectrum->type) {
+  case FFT_WIRE_SPECTRUM_F32:
+    return get_f32(v + 4 * index);
+  case FFT_WIRE_SPECTRUM_Q15: {
+    float m = (v[2 * index] | (v[2 * index + 1] << 8)) * (64.0f * NSAMP / 32768.0f);
+    return m * m;
+  }
+  default:
+    return powf(10.0f, (FFT_DB8_FLOOR_DB + v[index] * FFT_DB8_STEP_DB) / 10.0f);
+  }
+}
+
+bool fft_wire_get_pitch(const fft_wire_frame_t *frame, float *frequency, float *clarity, uint8_t *source) {
+  if (frame->type != FFT_WIRE_PITCH || frame->length < 8) {
+    return false;
+  }
+  *frequency = get_f32(frame->payload);
+  *clarity = get_f32(frame->payload + 4);
+  *source = frame->length > 8 ? frame->payload[8] : FFT_WIRE_PITCH_UNKNOWN;
+  return true;
+}
+
+// CRC-16/CCITT-FALSE when started from 0xffff
+uint16_t fft_wire_crc16(uint16_t crc, const uint8_t *data, size_t len) {
+  while (len--) {
+    crc ^= (uint16_t)(*data++ << 8);
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+// Runs the bytes from scan to end through the frame parser; stops after a valid frame
+static bool process(fft_wire_decoder_t *dec, fft_wire_frame_t *frame) {
+  while (dec->scan < dec->end) {
+    uint8_t byte = dec->buf[dec->scan++];
+    int pos = dec->scan - dec->start;
+
+    switch (dec->state) {
+    case WAIT_SYNC0:
+      if (byte == FFT_WIRE_SYNC0) {
+        dec->state = WAIT_SYNC1;
+      } else {
+        dec->start = dec->scan;
+      }
+      break;
+    case WAIT_SYNC1:
+      if (byte == FFT_WIRE_SYNC1) {
+        dec->state = READ_HEAD;
+      } else {
+        rescan(dec);
+      }
+      break;
+    case READ_HEAD:
+      if (pos == FFT_WIRE_HEADER_SIZE) {
+        const uint8_t *head = dec->buf + dec->start;
+        dec->length = head[4] | (head[5] << 8);
+        if (dec->length <= FFT_WIRE_MAX_PAYLOAD) {
+          dec->state = READ_PAYLOAD;
+        } else {
+          rescan(dec);
+        }
+      }
+      break;
+    default:
+      if (pos == FFT_WIRE_HEADER_SIZE + dec->length + FFT_WIRE_CRC_SIZE) {
+        const uint8_t *raw = dec->buf + dec->start;
+        const uint8_t *tail = raw + FFT_WIRE_HEADER_SIZE + dec->length;
+        uint16_t crc = fft_wire_crc16(0xffff, raw + 2, FFT_WIRE_HEADER_SIZE - 2 + dec->length);
+        if (crc != (tail[0] | (tail[1] << 8))) {
+          dec->crc_errors++;
+          rescan(dec);
+          break;
+        }
+        dec->start = dec->scan;
+        dec->state = WAIT_SYNC0;
+        if (finish_frame(dec, raw, frame)) {
+          return true;
+        }
+      }
+      break;
+    }
+  }
+  if (dec->start == dec->end) {
+    dec->start = dec->scan = dec->end = 0;
+  }
+  return false;
+}
+
+// The frame at start was not one: look for the next sync from the byte after it
+static void rescan(fft_wire_decoder_t *dec) {
+  dec->start++;
+  dec->scan = dec->start;
+  dec->state = WAIT_SYNC0;
+}
+
+static uint16_t begin_frame(fft_wire_encoder_t *enc, uint8_t type, size_t length) {
+  uint8_t head[FFT_WIRE_HEADER_SIZE] = {
+    FFT_WIRE_SYNC0, FFT_WIRE_SYNC1, type, enc->seq++, (uint8_t)(length & 0xff), (uint8_t)(length >> 8)
+  };
+
+  enc->write(head, sizeof(head));
+  return fft_wire_crc16(0xffff, head + 2, sizeof(head) - 2);
+}
+
+static uint16_t write_part(fft_wire_encoder_t *enc, uint16_t crc, const uint8_t *data, size_t len) {
+  enc->write(data, len);
+  return fft_wire_crc16(crc, data, len);
+}
+
+static void end_frame(fft_wire_encoder_t *enc, uint16_t crc) {
+  uint8_t tail[FFT_WIRE_CRC_SIZE] = {(uint8_t)(crc & 0xff), (uint8_t)(crc >> 8)};
+  enc->write(tail, sizeof(tail));
+}
+
+// Samples and dB8 spectra: delta coded against the previous frame of the type when that is shorter
+static bool send_bytes(fft_wire_encoder_t *enc, uint8_t type, const uint8_t *head, size_t head_len, const uint8_t *body, int count) {
+  fft_wire_reference_t *ref = reference_for(enc->refs, type);
+  uint8_t seq = enc->seq;
+  size_t len = count;
+  size_t coded = 0;
+
+  // Keyframes go out in full, so the full size has to fit even when this one would be delta coded
+  if (!payload_fits(count, 1, head_len)) {
+    return false;
+  }
+  if (enc->delta && ref->valid && ref->length == len && ref->countdown > 0) {
+    coded = delta_encode(ref->body, body, len, enc->scratch);
+  }
+
+  if (coded) {
+    uint8_t base = ref->seq;
+    uint16_t crc = begin_frame(enc, type | FFT_WIRE_DELTA, head_len + 1 + coded);
+    crc = write_part(enc, crc, head, head_len);
+    crc = write_part(enc, crc, &base, 1);
+    end_frame(enc, write_part(enc, crc, enc->scratch, coded));
+    ref->countdown--;
+  } else {
+    uint16_t crc = begin_frame(enc, type, head_len + len);
+    crc = write_part(enc, crc, head, head_len);
+    end_frame(enc, write_part(enc, crc, body, len));
+    ref->countdown = FFT_WIRE_KEYFRAME_INTERVAL - 1;
+  }
+
+  ref->valid = enc->delta && len <= FFT_WIRE_DELTA_MAX;
+  if (ref->valid) {
+    memcpy(ref->body, body, len);
+    ref->length = len;
+    ref->seq = seq;
+  }
+  return true;
+}
+
+// No message when it does not: on the Pico stderr may share the USB link with the frames
+static bool payload_fits(int count, int value_size, size_t head_len) {
+  return count >= 0 && head_len + (size_t)count * value_size <= FFT_WIRE_MAX_PAYLOAD;
+}
+
+// Returns the coded length, or 0 when coding would not save anything
+static size_t delta_encode(const uint8_t *prev, const uint8_t *cur, size_t len, uint8_t *out) {
+  size_t n = 0;
+  size_t i = 0;
+
+  while (i < len) {
+    uint8_t d = cur[i] - prev[i];
+    if (d) {
+      if (n + 1 >= len) {
+        return 0;
+      }
+      out[n++] = d;
+      i++;
+      continue;
+    }
+    size_t run = 1;
+    while (i + run < len && run < 256 && cur[i + run] == prev[i + run]) {
+      run++;
+    }
+    if (n + 2 >= len) {
+      return 0;
+    }
+    out[n++] = 0;
+    out[n++] = (uint8_t)(run - 1);
+    i += run;
+  }
+  return n;
+}
+
+static void put_spectrum_head(uint8_t *head, float first_hz, float step_hz) {
+  put_f32(head, first_hz);
+  put_f32(head + 4, step_hz);
+}
+
+// Rebuilds delta-coded frames and keeps the references for the next ones
+static bool finish_frame(fft_wire_decoder_t *dec, const uint8_t *raw, fft_wire_frame_t *frame) {
+  const uint8_t *payload = raw + FFT_WIRE_HEADER_SIZE;
+  uint8_t type = raw[2] & ~FFT_WIRE_DELTA;
+  size_t head_len = head_size(type);
+  fft_wire_reference_t *ref = reference_for(dec->refs, type);
+
+  frame->type = type;
+  frame->seq = raw[3];
+  frame->length = dec->length;
+  frame->payload = payload;
+
+  if (raw[2] & FFT_WIRE_DELTA) {
+    if (!ref || dec->length < head_len + 1 || !ref->valid || ref->seq != payload[head_len]) {
+      if (ref) {
+        ref->valid = false;
+      }
+      dec->missing_references++;
+      return false;
+    }
+
+    const uint8_t *in = payload + head_len + 1;
+    const uint8_t *in_end = payload + dec->length;
+    uint8_t *out = dec->delta_out + head_len;
+    size_t i = 0;
+
+    memcpy(dec->delta_out, payload, head_len);
+    while (in < in_end && i < ref->length) {
+      if (*in) {
+        out[i] = ref->body[i] + *in++;
+        i++;
+      } else if (in + 1 < in_end) {
+        for (int run = in[1] + 1; run > 0 && i < ref->length; run--, i++) {
+          out[i] = ref->body[i];
+        }
+        in += 2;
+      } else {
+        break;
+      }
+    }
+    if (in != in_end || i != ref->length) {
+      ref->valid = false;
+      dec->missing_references++;
+      return false;
+    }
+    frame->payload = dec->delta_out;
+    frame->length = head_len + ref->length;
+  }
+
+  if (ref) {
+    size_t len = frame->length >= head_len ? frame->length - head_len : 0;
+    ref->valid = frame->length >= head_len && len <= FFT_WIRE_DELTA_MAX;
+    if (ref->valid) {
+      memmove(ref->body, frame->payload + head_len, len);
+      ref->length = len;
+      ref->seq = frame->seq;
+    }
+  }
+  dec->frames++;
+  return true;
+}
+
+static fft_wire_reference_t *reference_for(fft_wire_reference_t *refs, uint8_t type) {
+  if (type == FFT_WIRE_SAMPLES) {
+    return &refs[0];
+  }
+  if (type == FFT_WIRE_SPECTRUM_DB8) {
+    return &refs[1];
+  }
+  return NULL;
+}
+
+static size_t head_size(uint8_t type) {
+  return type == FFT_WIRE_SAMPLES ? SAMPLES_HEAD_SIZE : SPECTRUM_HEAD_SIZE;
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+  p[0] = v & 0xff;
+  p[1] = (v >> 8) & 0xff;
+  p[2] = (v >> 16) & 0xff;
+  p[3] = v >> 24;
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+  return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put_f32(uint8_t *p, float v) {
+  uint32_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  put_u32(p, bits);
+}
+
+static float get_f32(const uint8_t *p) {
+  uint32_t bits = get_u32(p);
+  float v;
+  memcpy(&v, &bits, sizeof(v));
+  return v;
+}
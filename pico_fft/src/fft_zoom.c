@@ -0,0 +1,105 @@
+#include "pico/fft_zoom.h"
+
+static kiss_fft_cpx chirp(double cycles);
+static size_t align8(size_t size);
+
+bool fft_zoom_init(fft_zoom_t *zoom, int nsamp, float freq_min, float freq_max, int points, void *mem, size_t *lenmem) {
+  int nfft = kiss_fft_next_fast_size(nsamp + points - 1);
+  size_t cfg_len = 0;
+
+  kiss_fft_alloc(nfft, 0, NULL, &cfg_len);
+  cfg_len = align8(cfg_len);
+  size_t memneeded = cfg_len + sizeof(kiss_fft_cpx) * (nsamp + points + 2 * nfft);
+
+  if (!mem || *lenmem < memneeded) {
+    *lenmem = memneeded;
+    return false;
+  }
+  *lenmem = memneeded;
+
+  zoom->nsamp = nsamp;
+  zoom->points = points;
+  zoom->nfft = nfft;
+  zoom->freq_min = freq_min;
+  zoom->freq_step = points > 1 ? (freq_max - freq_min) / (points - 1) : 0;
+  zoom->cfg = kiss_fft_alloc(nfft, 0, mem, &cfg_len);
+  zoom->pre = (kiss_fft_cpx *)((char *)mem + cfg_len);
+  zoom->post = zoom->pre + nsamp;
+  zoom->filter = zoom->post + points;
+  zoom->work = zoom->filter + nfft;
+
+  // X[k] = post[k] * sum_n (x[n] pre[n]) conj_chirp[k - n], with chirps in units of freq_step
+  double start = (double)freq_min / FSAMP;
+  double step = (double)zoom->freq_step / FSAMP;
+
+  for (int n = 0; n < nsamp; n++) {
+    zoom->pre[n] = chirp(-start * n - 0.5 * step * n * n);
+  }
+  for (int k = 0; k < points; k++) {
+    zoom->post[k] = chirp(-0.5 * step * k * k);
+  }
+
+  memset(zoom->work, 0, sizeof(kiss_fft_cpx) * nfft);
+  for (int m = 0; m < points; m++) {
+    zoom->work[m] = chirp(0.5 * step * m * m);
+  }
+  for (int m = 1; m < nsamp; m++) {
+    zoom->work[nfft - m] = chirp(0.5 * step * m * m);
+  }
+  kiss_fft(zoom->cfg, zoom->work, zoom->filter);
+  for (int i = 0; i < nfft; i++) {
+    zoom->filter[i].r /= nfft;
+    zoom->filter[i].i /= nfft;
+  }
+  return true;
+}
+
+// out receives zoom->points complex values on the same scale as kiss_fftr outputs
+void fft_zoom_process(fft_zoom_t *zoom, const uint8_t *samples, kiss_fft_cpx *out) {
+  kiss_fft_cpx *work = zoom->work;
+  uint32_t sum = 0;
+
+  for (int n = 0; n < zoom->nsamp; n++) {
+    sum += samples[n];
+  }
+  float avg = (float)sum / zoom->nsamp;
+
+  for (int n = 0; n < zoom->nsamp; n++) {
+    float x = samples[n] - avg;
+    work[n].r = x * zoom->pre[n].r;
+    work[n].i = x * zoom->pre[n].i;
+  }
+  memset(work + zoom->nsamp, 0, sizeof(kiss_fft_cpx) * (zoom->nfft - zoom->nsamp));
+
+  // Forward transform, multiply, then the inverse as conj(FFT(conj(.)))
+  kiss_fft(zoom->cfg, work, work);
+  for (int i = 0; i < zoom->nfft; i++) {
+    kiss_fft_cpx a = work[i];
+    kiss_fft_cpx b = zoom->filter[i];
+    work[i].r = a.r * b.r - a.i * b.i;
+    work[i].i = -(a.r * b.i + a.i * b.r);
+  }
+  kiss_fft(zoom->cfg, work, work);
+
+  for (int k = 0; k < zoom->points; k++) {
+    kiss_fft_cpx g = work[k];
+    kiss_fft_cpx p = zoom->post[k];
+    out[k].r = g.r * p.r + g.i * p.i;
+    out[k].i = g.r * p.i - g.i * p.r;
+  }
+}
+
+float fft_zoom_frequency(const fft_zoom_t *zoom, int index) {
+  return zoom->freq_min + index * zoom->freq_step;
+}
+
+// e^(j 2 pi cycles), reduced in double first because the chirp phases grow quadratically
+static kiss_fft_cpx chirp(double cycles) {
+  double phase = 2 * M_PI * (cycles - floor(cycles));
+  kiss_fft_cpx c = {(kiss_fft_scalar)cos(phase), (kiss_fft_scalar)sin(phase)};
+  return c;
+}
+
+static size_t align8(size_t size) {
+  return (size + 7) & ~(size_t)7;
+}
@@ -16,6 +16,9 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
    defines kiss_fft_scalar as either short or a float type
    and defines
    typedef struct { kiss_fft_scalar r; kiss_fft_scalar i; }kiss_fft_cpx; */
+#ifndef KISS_FFT_GUTS_H
+#define KISS_FFT_GUTS_H
+
 #include "pico/kiss_fft.h"
 #include <limits.h>
 
@@ -25,13 +28,37 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
  4*4*4*2
  */
 
+/* kf_bfly_generic keeps its scratch on the stack up to this radix */
+#define KF_GENERIC_STACK_RADIX 17
+
 struct kiss_fft_state{
     int nfft;
     int inverse;
     int factors[2*MAXFACTORS];
-    kiss_fft_cpx twiddles[1];
+    const kiss_fft_cpx * twiddles; /* just past the struct, or a table in flash */
+    unsigned short * cycles; /* input permutation for in-place transforms, NULL above KF_CYCLES_MAX_NFFT */
 };
 
+/* kiss_fftr's state, here rather than in kiss_fftr.c so that the host tests can read its tables */
+struct kiss_fftr_state{
+    kiss_fft_cfg substate;
+    kiss_fft_cpx * tmpbuf;
+    const kiss_fft_cpx * super_twiddles;
+#ifdef USE_SIMD
+    void * pad;
+#endif
+};
+
+/* The cycle table holds each cycle of the input permutation followed by
+   KF_CYCLE_END, then one more KF_CYCLE_END. Fixed points are left out, so it
+   never exceeds nfft + nfft/2 + 1 entries. A bitmap used while building it
+   follows the entries. */
+#define KF_CYCLE_END 0xffff
+#define KF_CYCLES_MAX_NFFT 0xffff
+#define KF_CYCLES_SIZE(nfft) \
+    ((nfft) > KF_CYCLES_MAX_NFFT ? 0 : \
+     ((sizeof(unsigned short) * ((nfft) + (nfft) / 2 + 2) + ((nfft) + 7) / 8 + 7) & ~(size_t)7))
+
 /*
   Explanation of macros dealing with complex math:
 
@@ -132,6 +159,10 @@ struct kiss_fft_state{
 #  define KISS_FFT_COS(phase) _mm_set1_ps( cos(phase) )
 #  define KISS_FFT_SIN(phase) _mm_set1_ps( sin(phase) )
 #  define HALF_OF(x) ((x)*_mm_set1_ps(.5))
+#elif defined(KISS_FFT_LANES)
+#  define KISS_FFT_COS(phase) ((kiss_fft_scalar){0} + (float)cos(phase))
+#  define KISS_FFT_SIN(phase) ((kiss_fft_scalar){0} + (float)sin(phase))
+#  define HALF_OF(x) ((x)*.5f)
 #else
 #  define KISS_FFT_COS(phase) (kiss_fft_scalar) cos(phase)
 #  define KISS_FFT_SIN(phase) (kiss_fft_scalar) sin(phase)
@@ -162,3 +193,5 @@ struct kiss_fft_state{
 #define  KISS_FFT_TMP_ALLOC(nbytes) KISS_FFT_MALLOC(nbytes)
 #define  KISS_FFT_TMP_FREE(ptr) KISS_FFT_FREE(ptr)
 #endif
+
+#endif /* KISS_FFT_GUTS_H */
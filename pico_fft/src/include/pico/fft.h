@@ -2,7 +2,15 @@
 #define FFT_H
 
 #include "pico/stdlib.h"
+#include "pico/fft_config.h"
+#include "pico/fft_window.h"
+#include "pico/fft_kernel.h"
+#include "pico/fft_twiddles.h"
 #include "pico/kiss_fftr.h"
+#include "pico/kiss_fft_fixed.h"
+#include "pico/fft_capture.h"
+#include "pico/fft_ring.h"
+#include "pico/fft_profile.h"
 #include "hardware/adc.h"
 #include "hardware/dma.h"
 
@@ -10,12 +18,6 @@
 #include <math.h>
 
 
-#define FSAMP 8000
-#define CLOCK_DIV   (48000000.0f / FSAMP)
-
-#define CAPTURE_CHANNEL 2
-#define NSAMP 2000
-
 typedef struct {
     const char *name;
     int freq_min;
@@ -23,8 +25,94 @@ typedef struct {
     float amplitude;
 } frequency_bin_t;
 
+/* Energies are in Q15^2 units of the spectrum normalised by NSAMP */
+typedef struct {
+    const char *name;
+    int freq_min;
+    int freq_max;
+    uint64_t energy;
+} frequency_bin_fixed_t;
+
+/* A plan holds kiss_fftr's work buffer, so transforms running at the same time need one plan each */
+typedef struct {
+    kiss_fftr_cfg cfg;
+    int nfft;
+} fft_plan_t;
+
+typedef enum {
+    FFT_PEAK_PARABOLIC, // parabola through the three magnitudes around the peak
+    FFT_PEAK_JACOBSEN,  // Jacobsen's estimator on the complex outputs
+    FFT_PEAK_QUINN      // Quinn's first estimator on the complex outputs
+} fft_peak_method_t;
+
+typedef struct {
+    int index;        // FFT index of the largest output
+    float offset;     // refined peak position relative to index, in bins
+    float frequency;  // refined peak frequency in Hz
+    float magnitude;
+} fft_peak_t;
+
+/* What each bin's 'amplitude' holds, from most to least expensive on the RP2040 */
+typedef enum {
+    FFT_SCALE_MAGNITUDE,      // sqrt of the summed power
+    FFT_SCALE_POWER,          // summed power, enough for ordering bins
+    FFT_SCALE_FAST_MAGNITUDE  // alpha-max-plus-beta-min |X| (within 4%) of the bin's strongest output
+} fft_scale_t;
+
+/* Bins resolved to FFT index ranges once, with the amplitudes kept contiguous */
+typedef struct {
+    int bin_count;
+    float *amplitude;
+    uint16_t *start;  // first FFT index of each bin
+    uint16_t *end;    // one past its last FFT index
+} fft_bin_bank_t;
+
+#define FFT_BIN_BANK_MEM_SIZE(bin_count) ((bin_count) * (sizeof(float) + 2 * sizeof(uint16_t)))
+
+/* Sliding window over the most recent NSAMP samples, analysed every 'hop' samples */
+typedef struct {
+    uint8_t history[NSAMP];
+    int pos;      // oldest sample, where the next one is written
+    int filled;   // valid samples in history
+    int hop;
+    int pending;  // samples pushed since the last analysis
+} fft_stream_t;
+
+/* Upper bound of the bytes kiss_fftr_alloc places into 'mem' for an nfft-point plan,
+   including the in-place cycle table (at most 4 bytes per complex point) */
+#define FFT_PLAN_MEM_SIZE(nfft) \
+    (5 * sizeof(void *) + (2 + 2 * 32) * sizeof(int) + \
+     sizeof(kiss_fft_cpx) * ((nfft) / 2 + ((nfft) / 2) * 3 / 2 + 1) + 4 * ((nfft) / 2) + 16)
+
+/* The same for sizes with build-time twiddles (fft_twiddles.h): only the state, cycle table and a work buffer */
+#define FFT_PLAN_STATIC_MEM_SIZE(nfft) \
+    (5 * sizeof(void *) + (2 + 2 * 32) * sizeof(int) + \
+     sizeof(kiss_fft_cpx) * ((nfft) / 2) + 4 * ((nfft) / 2) + 16)
+
 void fft_setup();
+void fft_set_sample_rate(float hz);
+void fft_set_window(fft_window_t type);
+bool fft_plan_create(fft_plan_t *plan, int nfft, bool inverse, void *mem, size_t *lenmem);
 void fft_sample(uint8_t *capture_buf);
 void fft_process(uint8_t *capture_buf, frequency_bin_t *bins, int bin_count);
+void fft_process_scaled(uint8_t *capture_buf, frequency_bin_t *bins, int bin_count, fft_scale_t scale);
+void fft_process_db8(uint8_t *capture_buf, frequency_bin_t *bins, int bin_count, uint8_t *db);
+void fft_power_to_db8(const float *power, uint8_t *db, int count);
+bool fft_bin_bank_init(fft_bin_bank_t *bank, const frequency_bin_t *bins, int bin_count, void *mem, size_t *lenmem);
+void fft_bin_bank_set(fft_bin_bank_t *bank, int index, float freq_min, float freq_max);
+void fft_process_bank(uint8_t *capture_buf, fft_bin_bank_t *bank);
+void fft_bin_bank_accumulate(fft_bin_bank_t *bank, const kiss_fft_cpx *fft_out);
+void fft_bin_bank_accumulate_scaled(fft_bin_bank_t *bank, const kiss_fft_cpx *fft_out, fft_scale_t scale);
+void fft_process_spectrum(uint8_t *capture_buf, kiss_fft_cpx *fft_out);
+void fft_process_batch(const uint8_t *frames, int count, kiss_fft_cpx *spectra);
+int fft_batch_lanes();
+float fft_bin_frequency(int index);
+float fft_refine_peak(const kiss_fft_cpx *fft_out, int index, fft_peak_method_t method);
+bool fft_find_peak(const kiss_fft_cpx *fft_out, int index_min, int index_max, fft_peak_method_t method, fft_peak_t *peak);
+void fft_stream_init(fft_stream_t *stream, int hop);
+bool fft_stream_push(fft_stream_t *stream, const uint8_t *samples, int count);
+void fft_stream_process(fft_stream_t *stream, frequency_bin_t *bins, int bin_count);
+void fft_process_q15(uint8_t *capture_buf, frequency_bin_fixed_t *bins, int bin_count);
+void fft_process_q31(uint8_t *capture_buf, frequency_bin_fixed_t *bins, int bin_count);
 
 #endif /* FFT_H */
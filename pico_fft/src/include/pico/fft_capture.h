@@ -0,0 +1,43 @@
+#ifndef FFT_CAPTURE_H
+#define FFT_CAPTURE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Continuous double-buffered capture. The hardware fills the two buffers in
+ * turn without ever stopping; the consumer takes the most recently completed
+ * one with fft_capture_acquire() and hands it back with fft_capture_release()
+ * before the hardware comes round to it again, i.e. within one buffer period.
+ */
+
+typedef struct {
+    // Fill buf_a, then buf_b, then buf_a ... with count samples each, calling
+    // fft_capture_complete() (usually from an IRQ) as each buffer fills up
+    bool (*start)(uint8_t *buf_a, uint8_t *buf_b, int count);
+    void (*stop)(void);
+    // Keep fft_capture_complete() from running while the state is updated
+    uint32_t (*lock)(void);
+    void (*unlock)(uint32_t state);
+} fft_capture_hal_t;
+
+typedef struct {
+    uint32_t frames;   // buffers filled by the hardware
+    uint32_t dropped;  // filled buffers that were never acquired
+    uint32_t overruns; // acquired buffers the hardware wrote into before release
+} fft_capture_stats_t;
+
+// DMA based implementation on the Pico, which requires fft_setup() to have configured the ADC; a simulated ADC in the host build (host_hal.h)
+const fft_capture_hal_t *fft_capture_platform_hal(void);
+
+void fft_capture_set_hal(const fft_capture_hal_t *hal);
+bool fft_capture_start(uint8_t *buf_a, uint8_t *buf_b, int count);
+void fft_capture_stop(void);
+uint8_t *fft_capture_acquire(void);
+bool fft_capture_release(uint8_t *buf);
+void fft_capture_get_stats(fft_capture_stats_t *stats);
+
+// Called by the HAL when buffer 'index' (0 = buf_a, 1 = buf_b) has been filled
+void fft_capture_complete(int index);
+
+#endif /* FFT_CAPTURE_H */
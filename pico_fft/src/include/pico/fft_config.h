@@ -0,0 +1,36 @@
+#ifndef FFT_CONFIG_H
+#define FFT_CONFIG_H
+
+/* Capture configuration, kept free of SDK includes so build-time table generators and host tools can use it */
+
+#define FSAMP 8000
+#define CLOCK_DIV   (48000000.0f / FSAMP)
+
+#define CAPTURE_CHANNEL 2
+#define NSAMP 2000
+
+#define FFT_BIN_HZ ((float)FSAMP / NSAMP)
+
+/* 8-bit log spectrum: code = (10 log10(power) - FFT_DB8_FLOOR_DB) / FFT_DB8_STEP_DB, clamped to 0..255 */
+#define FFT_DB8_FLOOR_DB 0.0f
+#define FFT_DB8_STEP_DB 0.5f
+
+/* Pitch detector analysis window, at least two periods of the lowest pitch */
+#define FFT_PITCH_NSAMP 512
+
+/* Size of the lean in-place transform (fft_lean.h) whose twiddles are built into flash, 0 for none */
+#ifndef FFT_LEAN_NFFT
+#define FFT_LEAN_NFFT 0
+#endif
+
+/* 1: the float NSAMP-point FFT runs through the compile-time specialised kernel (fft_kernel.cpp) instead of a kiss_fftr plan */
+#ifndef FFT_STATIC_KERNEL
+#define FFT_STATIC_KERNEL 1
+#endif
+
+/* 1: time the analysis stages and keep per-stage latency stats (fft_profile.h); 0 compiles the timing out */
+#ifndef FFT_PROFILE
+#define FFT_PROFILE 0
+#endif
+
+#endif /* FFT_CONFIG_H */
@@ -0,0 +1,37 @@
+#ifndef FFT_DECIMATE_H
+#define FFT_DECIMATE_H
+
+#include "pico/fft.h"
+
+/*
+ * Streaming decimator for an oversampled ADC. A CIC filter decimates by
+ * cic_factor and a compensating half-band-style FIR, designed at init time,
+ * flattens its droop and decimates by a further 2.
+ *
+ *   analysis rate = ADC rate / (2 * cic_factor)
+ */
+
+#define FFT_CIC_ORDER 4
+#define FFT_CIC_MAX_FACTOR 32        // keeps the CIC gain, and so its output, inside int32
+#define FFT_DECIM_TAPS 31
+// Output samples are signed with this many fractional bits below the 8-bit ADC LSB
+#define FFT_DECIM_FRAC_BITS 7
+
+typedef struct {
+    int cic_factor;
+    int cic_shift;                       // log2(cic_factor^FFT_CIC_ORDER)
+    int cic_phase;
+    uint32_t integ[FFT_CIC_ORDER];       // wrap-around arithmetic is intended
+    uint32_t comb[FFT_CIC_ORDER];        // previous input of each comb stage
+    int16_t taps[FFT_DECIM_TAPS];        // Q15
+    int32_t history[2 * FFT_DECIM_TAPS]; // mirrored so the newest FFT_DECIM_TAPS are contiguous
+    int hpos;
+    int fir_phase;
+} fft_decimator_t;
+
+bool fft_decimator_init(fft_decimator_t *dec, int cic_factor);
+void fft_decimator_reset(fft_decimator_t *dec);
+int fft_decimate(fft_decimator_t *dec, const uint8_t *in, int count, int16_t *out);
+void fft_decimated_spectrum(const fft_plan_t *plan, const int16_t *samples, kiss_fft_cpx *fft_out);
+
+#endif /* FFT_DECIMATE_H */
@@ -0,0 +1,30 @@
+#ifndef FFT_GOERTZEL_H
+#define FFT_GOERTZEL_H
+
+#include "pico/fft.h"
+
+/*
+ * Goertzel filter bank: evaluates the spectrum only at a registered set of
+ * frequencies. Each filter costs a pass over the samples, so the bank beats
+ * the FFT only for a few targets (see the break-even line of fft_bench).
+ * Powers are on the same scale as |fft_out[k]|^2.
+ */
+
+#define FFT_GOERTZEL_MAX_TARGETS 64
+
+typedef struct {
+    int count;
+    float freq[FFT_GOERTZEL_MAX_TARGETS];
+    float coeff[FFT_GOERTZEL_MAX_TARGETS];        // 2 cos(w)
+    int32_t coeff_q29[FFT_GOERTZEL_MAX_TARGETS];
+    float power[FFT_GOERTZEL_MAX_TARGETS];
+} fft_goertzel_bank_t;
+
+void fft_goertzel_init(fft_goertzel_bank_t *bank);
+int fft_goertzel_add(fft_goertzel_bank_t *bank, float freq, float cents_step, int neighbours);
+void fft_goertzel_process(fft_goertzel_bank_t *bank, const uint8_t *samples, int count);
+void fft_goertzel_process_fixed(fft_goertzel_bank_t *bank, const uint8_t *samples, int count);
+int fft_goertzel_peak(const fft_goertzel_bank_t *bank, int first, int count);
+float fft_goertzel_refine(const fft_goertzel_bank_t *bank, int index, int first, int count);
+
+#endif /* FFT_GOERTZEL_H */
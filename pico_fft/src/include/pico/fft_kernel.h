@@ -0,0 +1,25 @@
+#ifndef FFT_KERNEL_H
+#define FFT_KERNEL_H
+
+#include "pico/fft_config.h"
+#include "pico/kiss_fft.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Real forward FFT of exactly NSAMP points, specialised at compile time.
+ * The factorisation, strides and loop bounds are template constants, the
+ * stage recursion is unrolled and the twiddles are const tables in flash.
+ * The arithmetic follows kiss_fftr operation for operation, so outputs match
+ * an NSAMP-point kiss_fftr plan. It keeps no state between calls, so both
+ * cores can run it at once; timedata and freqdata must not overlap.
+ */
+void fft_kernel_fftr(const kiss_fft_scalar *timedata, kiss_fft_cpx *freqdata);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FFT_KERNEL_H */
@@ -0,0 +1,35 @@
+#ifndef FFT_LEAN_H
+#define FFT_LEAN_H
+
+#include "pico/fft.h"
+
+/*
+ * Memory-lean real FFT for long frames (4096-8192 points). The transform runs
+ * in place on one caller-owned buffer of nfft floats and leaves the spectrum
+ * there packed as half-complex:
+ *   buf[0] = X[0], buf[1] = X[nfft/2]                (both purely real)
+ *   buf[2k] = Re X[k], buf[2k + 1] = Im X[k]         for 0 < k < nfft/2
+ * The values are those kiss_fftr would return. Windows are applied to the
+ * packed spectrum as the cosine sums they are, so no nfft-entry window table
+ * is needed.
+ */
+
+typedef struct {
+    int nfft;
+    const fft_window_info_t *window;
+    kiss_fft_cfg cfg;                    // nfft/2 point complex transform, run in place
+    const kiss_fft_cpx *super_twiddles;  // nfft/4, in flash for FFT_LEAN_NFFT
+} fft_lean_t;
+
+/* Upper bound for fft_lean_init's 'mem'; the exact size is returned in *lenmem */
+#define FFT_LEAN_MEM_SIZE(nfft) \
+    ((2 + 2 * 32) * sizeof(int) + 2 * sizeof(void *) + 16 + \
+     sizeof(kiss_fft_cpx) * ((nfft) / 2 + (nfft) / 4) + 4 * ((nfft) / 2))
+
+bool fft_lean_init(fft_lean_t *lean, int nfft, fft_window_t window, void *mem, size_t *lenmem);
+void fft_lean_forward(const fft_lean_t *lean, float *buf);
+void fft_lean_process(const fft_lean_t *lean, const uint8_t *samples, float *buf, frequency_bin_t *bins, int bin_count);
+kiss_fft_cpx fft_lean_output(const fft_lean_t *lean, const float *buf, int k);
+float fft_lean_bin_frequency(const fft_lean_t *lean, int k);
+
+#endif /* FFT_LEAN_H */
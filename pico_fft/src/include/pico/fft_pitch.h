@@ -0,0 +1,25 @@
+#ifndef FFT_PITCH_H
+#define FFT_PITCH_H
+
+#include "pico/fft.h"
+
+/*
+ * Time-domain pitch detection with the McLeod Pitch Method. The normalised
+ * square difference function is built from an autocorrelation computed with
+ * kiss_fftr/kiss_fftri, so a window costs O(N log N).
+ */
+
+// Analysis window FFT_PITCH_NSAMP is set in fft_config.h
+#define FFT_PITCH_MIN_HZ 60.0f
+#define FFT_PITCH_MAX_HZ 1000.0f
+// Fraction of the highest NSDF peak the first accepted peak must reach
+#define FFT_PITCH_CUTOFF 0.93f
+
+typedef struct {
+    float frequency;  // Hz, 0 when no pitch was found
+    float clarity;    // height of the chosen NSDF peak, 1 for a perfectly periodic signal
+} fft_pitch_t;
+
+bool fft_pitch_detect(const uint8_t *samples, fft_pitch_t *pitch);
+
+#endif /* FFT_PITCH_H */
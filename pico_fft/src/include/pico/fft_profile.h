@@ -0,0 +1,83 @@
+#ifndef FFT_PROFILE_H
+#define FFT_PROFILE_H
+
+#include "pico/stdlib.h"
+#include "pico/fft_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Per-stage latency statistics for the analysis loop. With FFT_PROFILE set
+ * to 1 (fft_config.h), the code between FFT_PROFILE_BEGIN(stage) and
+ * FFT_PROFILE_END(stage) is timed with the microsecond timer. Each stage
+ * keeps its count, min/avg/max and a log2 histogram. With FFT_PROFILE 0 the
+ * macros compile to nothing.
+ *
+ * The library times the stages inside fft_sample() and fft_process_*().
+ * The application times the rest. Each stage must only be recorded from one
+ * core. Stats that are read while another core records may be slightly
+ * inconsistent. fft_profile_reset() may be called from either core: it only
+ * flags the stages, and each one is cleared by the core recording it at its
+ * next sample. Until then the stage reads as empty.
+ */
+
+#define FFT_PROFILE_BUCKETS 16  // bucket 0: under 1 us, bucket k: 2^(k-1) to 2^k - 1 us, the last one everything longer
+
+typedef enum {
+    FFT_STAGE_CAPTURE,   // waiting for the DMA in fft_sample()
+    FFT_STAGE_WINDOW,    // fill_fft_input(): centring, window, conversion
+    FFT_STAGE_FFT,       // the NSAMP-point real FFT
+    FFT_STAGE_BINS,      // summing FFT outputs into bins or a bin bank
+    FFT_STAGE_DETECT,    // peak search, pitch detector or Goertzel filters
+    FFT_STAGE_PRINT,     // text output
+    FFT_STAGE_STREAM,    // fft_wire output
+    FFT_STAGE_DISPLAY,   // drawing and I2C transfers to the OLED
+    FFT_STAGE_FRAME,     // one whole update
+    FFT_STAGE_COUNT
+} fft_stage_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t histogram[FFT_PROFILE_BUCKETS];
+} fft_profile_stats_t;
+
+/* High-water marks in bytes, all 0 where they cannot be measured (the host build) */
+typedef struct {
+    uint32_t heap_used;        // allocated now
+    uint32_t heap_peak;        // largest the heap has grown
+    uint32_t stack_size[2];    // per core
+    uint32_t stack_peak[2];    // deepest use since fft_profile_init()
+} fft_profile_memory_t;
+
+#if FFT_PROFILE
+#define FFT_PROFILE_BEGIN(stage) uint32_t fft_profile_start_##stage = time_us_32()
+#define FFT_PROFILE_END(stage) fft_profile_record(stage, time_us_32() - fft_profile_start_##stage)
+#else
+#define FFT_PROFILE_BEGIN(stage) do {} while (0)
+#define FFT_PROFILE_END(stage) do {} while (0)
+#endif
+
+/* Clears the stats and marks the unused stacks; call before launching core1 */
+void fft_profile_init(void);
+void fft_profile_reset(void);
+void fft_profile_record(fft_stage_t stage, uint32_t us);
+
+const fft_profile_stats_t *fft_profile_stats(fft_stage_t stage);
+const char *fft_profile_stage_name(fft_stage_t stage);
+void fft_profile_memory(fft_profile_memory_t *mem);
+
+/* One line per recorded stage plus the memory high-water marks */
+void fft_profile_print(void);
+/* Prints and resets the stats if period_ms has passed since the last time; returns whether it did */
+bool fft_profile_print_every(uint32_t period_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FFT_PROFILE_H */
@@ -0,0 +1,77 @@
+#ifndef FFT_RECORD_H
+#define FFT_RECORD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Recording format for captured frames, meant to be mmapped on the host.
+ * A file is one fft_record_header_t followed by frame_count records of
+ * frame_size bytes each, so frame i starts at header_size + i * frame_size.
+ * Each record is an fft_record_frame_t, the frame's samples and, with
+ * FFT_RECORD_SPECTRUM, spectrum_count float powers starting at the next
+ * multiple of 4. Records are padded to a multiple of 8 bytes and all fields
+ * are little-endian.
+ *
+ * tools/fft_wire_dump.c -r records a TUNER_STREAM device, tools/fft_replay.c
+ * runs recordings back through the analysis and graph_fft.py plots them.
+ */
+
+#define FFT_RECORD_MAGIC "FFTR"
+#define FFT_RECORD_VERSION 1
+
+#define FFT_RECORD_SPECTRUM 0x01  // the device's bin powers are stored with each frame
+#define FFT_RECORD_PITCH 0x02     // the device's pitch result is stored with each frame
+
+typedef struct {
+    char magic[4];             // FFT_RECORD_MAGIC
+    uint16_t version;
+    uint16_t header_size;      // offset of the first frame
+    uint32_t sample_rate;
+    uint16_t frame_samples;
+    uint8_t sample_bits;       // significant bits per 8-bit sample, 8 for the byte-shifted ADC FIFO
+    uint8_t flags;
+    uint32_t frame_size;
+    uint32_t frame_count;      // 0 if the recorder was cut off; readers then go by the file size
+    uint16_t spectrum_count;
+    uint8_t pitch_source;      // fft_wire_pitch_source_t, replays only compare FFT_WIRE_PITCH_MPM pitches
+    uint8_t reserved;
+    float spectrum_first_hz;   // centre of the first spectrum value
+    float spectrum_step_hz;
+    uint32_t reserved2;
+} fft_record_header_t;
+
+typedef struct {
+    uint64_t time_us;          // device clock when the frame was sent
+    float pitch_hz;            // 0 when there was no pitch, or without FFT_RECORD_PITCH
+    float clarity;
+} fft_record_frame_t;
+
+/* A validated recording in memory, usually an mmapped file */
+typedef struct {
+    const fft_record_header_t *header;
+    const uint8_t *frames;
+    uint32_t frame_count;
+} fft_recording_t;
+
+void fft_record_header_init(fft_record_header_t *header, uint32_t sample_rate, int frame_samples, int sample_bits,
+                            uint8_t flags, int spectrum_count, float first_hz, float step_hz);
+size_t fft_record_frame_size(int frame_samples, int spectrum_count);
+void fft_record_pack(const fft_record_header_t *header, void *record, uint64_t time_us, const uint8_t *samples,
+                     const float *spectrum, float pitch_hz, float clarity);
+
+bool fft_record_open(fft_recording_t *rec, const void *data, size_t size);
+const fft_record_frame_t *fft_record_frame(const fft_recording_t *rec, uint32_t index);
+const uint8_t *fft_record_samples(const fft_recording_t *rec, const fft_record_frame_t *frame);
+const float *fft_record_spectrum(const fft_recording_t *rec, const fft_record_frame_t *frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FFT_RECORD_H */
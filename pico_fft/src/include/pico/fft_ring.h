@@ -0,0 +1,33 @@
+#ifndef FFT_RING_H
+#define FFT_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Lock-free single-producer/single-consumer ring of fixed-size slots, used to
+ * hand results from one core (or thread) to the other. The producer fills the
+ * slot returned by fft_ring_claim() in place and makes it visible with
+ * fft_ring_publish(); the consumer reads the slot returned by fft_ring_peek()
+ * and gives it back with fft_ring_release().
+ */
+
+typedef struct {
+    uint8_t *slots;
+    size_t slot_size;
+    uint32_t capacity;  // power of two
+    atomic_uint head;   // slots published, only written by the producer
+    atomic_uint tail;   // slots released, only written by the consumer
+} fft_ring_t;
+
+bool fft_ring_init(fft_ring_t *ring, void *storage, size_t slot_size, uint32_t capacity);
+
+void *fft_ring_claim(fft_ring_t *ring);
+void fft_ring_publish(fft_ring_t *ring);
+
+void *fft_ring_peek(fft_ring_t *ring);
+void fft_ring_release(fft_ring_t *ring);
+
+#endif /* FFT_RING_H */
@@ -0,0 +1,34 @@
+#ifndef FFT_SPECTROGRAM_H
+#define FFT_SPECTROGRAM_H
+
+#include "pico/fft.h"
+
+/*
+ * Spectrogram history: the last 'columns' frames as 8-bit dB columns (see
+ * FFT_DB8_FLOOR_DB) of 'rows' equal frequency bands between freq_min and
+ * freq_max. Appending overwrites the oldest column, so it never moves the
+ * history. Each column is contiguous, ready for a waterfall line; a row's
+ * history is gathered on request.
+ */
+
+typedef struct {
+    int rows;             // frequency bands, from freq_min upwards
+    int columns;          // frames of history
+    int head;             // column the next frame goes to
+    int count;            // frames held, up to columns
+    float freq_min;
+    float row_hz;         // width of each band
+    fft_bin_bank_t bank;  // FFT index ranges of the rows, and their powers
+    uint8_t *cells;       // columns x rows dB8 codes
+} fft_spectrogram_t;
+
+#define FFT_SPECTROGRAM_MEM_SIZE(rows, columns) (FFT_BIN_BANK_MEM_SIZE(rows) + (size_t)(rows) * (columns))
+
+bool fft_spectrogram_init(fft_spectrogram_t *sg, float freq_min, float freq_max, int rows, int columns, void *mem, size_t *lenmem);
+void fft_spectrogram_append(fft_spectrogram_t *sg, const kiss_fft_cpx *fft_out);
+void fft_spectrogram_append_db8(fft_spectrogram_t *sg, const uint8_t *column);
+const uint8_t *fft_spectrogram_column(const fft_spectrogram_t *sg, int age);
+int fft_spectrogram_row(const fft_spectrogram_t *sg, int row, uint8_t *out);
+float fft_spectrogram_row_frequency(const fft_spectrogram_t *sg, int row);
+
+#endif /* FFT_SPECTROGRAM_H */
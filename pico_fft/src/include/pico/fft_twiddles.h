@@ -0,0 +1,33 @@
+#ifndef FFT_TWIDDLES_H
+#define FFT_TWIDDLES_H
+
+#include <stdbool.h>
+#include "pico/fft_config.h"
+#include "pico/kiss_fft.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Real FFT twiddles generated at build time (fft_twiddles.cpp) for the sizes
+ * this library plans: the pitch detector's forward and inverse transforms,
+ * NSAMP when the specialised kernel is off and FFT_LEAN_NFFT when set.
+ * fft_plan_create() and fft_lean_init() point plans of these sizes at the
+ * tables instead of computing them.
+ */
+
+typedef struct {
+    int nfft;
+    bool inverse;
+    const kiss_fft_cpx *twiddles;        // nfft / 2
+    const kiss_fft_cpx *super_twiddles;  // nfft / 4
+} fft_twiddle_table_t;
+
+const fft_twiddle_table_t *fft_twiddle_table_find(int nfft, bool inverse);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FFT_TWIDDLES_H */
@@ -0,0 +1,40 @@
+#ifndef FFT_WINDOW_H
+#define FFT_WINDOW_H
+
+#include <stdint.h>
+#include "pico/fft_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Analysis windows for NSAMP-point frames. Every window is a periodic cosine
+ * sum, w[n] = sum_j (-1)^j a[j] cos(2 pi j n / NSAMP). Its tables are
+ * generated at compile time and live in flash.
+ */
+
+#define FFT_WINDOW_MAX_TERMS 5
+
+typedef enum {
+    FFT_WINDOW_RECT,
+    FFT_WINDOW_HANN,
+    FFT_WINDOW_BLACKMAN_HARRIS,  // 4-term, -92 dB sidelobes
+    FFT_WINDOW_FLAT_TOP,         // 5-term, amplitude-accurate between bins
+    FFT_WINDOW_COUNT
+} fft_window_t;
+
+typedef struct {
+    int terms;
+    float a[FFT_WINDOW_MAX_TERMS];
+    const float *table;       // NSAMP coefficients, NULL for FFT_WINDOW_RECT
+    const int16_t *table_q15; // the same in Q15
+} fft_window_info_t;
+
+const fft_window_info_t *fft_window_get(fft_window_t window);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FFT_WINDOW_H */
@@ -0,0 +1,136 @@
+#ifndef FFT_WIRE_H
+#define FFT_WIRE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pico/fft_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Binary streaming format for sending captures and results over USB CDC
+ * instead of printf text. Every frame is
+ *
+ *   0xA5 0x5A | type | seq | length (u16) | payload | CRC-16 (u16)
+ *
+ * with little-endian fields and a CRC-16/CCITT-FALSE over type to the end of
+ * the payload. Payloads open with a short header:
+ *
+ *   FFT_WIRE_SAMPLES     u32 sample rate, u32 device time in us, then 8-bit samples
+ *   FFT_WIRE_SPECTRUM_*  f32 frequency of the first value, f32 spacing, then the values
+ *   FFT_WIRE_PITCH       f32 frequency (0 when none), f32 clarity, u8 source
+ *
+ * Byte payloads (samples and dB8 spectra) can be delta coded: FFT_WIRE_DELTA
+ * is set in the type, and the header is followed by the seq of the frame
+ * they refer to and the byte-wise differences from it, with each run of zero
+ * differences written as 0, run length - 1. A full frame goes out every
+ * FFT_WIRE_KEYFRAME_INTERVAL frames of a type so a decoder can join late.
+ *
+ * The encoder runs on the Pico and writes through a callback; a send that
+ * would exceed FFT_WIRE_MAX_PAYLOAD writes nothing and returns false. The
+ * decoder takes one byte at a time and is meant for host tools
+ * (tools/fft_wire_dump.c). It keeps the bytes of the frame it is reading, so
+ * that after a false sync or a CRC error it rescans them from the byte after
+ * that sync instead of losing a frame that started inside them.
+ */
+
+#define FFT_WIRE_SYNC0 0xA5
+#define FFT_WIRE_SYNC1 0x5A
+#define FFT_WIRE_HEADER_SIZE 6
+#define FFT_WIRE_CRC_SIZE 2
+#define FFT_WIRE_MAX_PAYLOAD 16400    // a float spectrum of 4096 values
+#define FFT_WIRE_MAX_FRAME (FFT_WIRE_HEADER_SIZE + FFT_WIRE_MAX_PAYLOAD + FFT_WIRE_CRC_SIZE)
+#define FFT_WIRE_DELTA_MAX NSAMP      // longest body that is delta coded
+#define FFT_WIRE_KEYFRAME_INTERVAL 16
+
+#define FFT_WIRE_DELTA 0x80
+
+typedef enum {
+    FFT_WIRE_SAMPLES = 1,
+    FFT_WIRE_SPECTRUM_F32 = 2,  // power per value, as FFT_SCALE_POWER
+    FFT_WIRE_SPECTRUM_Q15 = 3,  // magnitude per value, 32767 for a full-scale sine over NSAMP samples
+    FFT_WIRE_SPECTRUM_DB8 = 4,  // dB8 codes, see FFT_DB8_FLOOR_DB
+    FFT_WIRE_PITCH = 5
+} fft_wire_type_t;
+
+/* What produced an FFT_WIRE_PITCH value, so that a replay only compares it with the same method */
+typedef enum {
+    FFT_WIRE_PITCH_UNKNOWN = 0,   // also what frames without the source byte decode to
+    FFT_WIRE_PITCH_MPM = 1,       // fft_pitch_detect()
+    FFT_WIRE_PITCH_SPECTRUM = 2,  // a peak search over the FFT spectrum
+    FFT_WIRE_PITCH_GOERTZEL = 3   // a Goertzel filter bank
+} fft_wire_pitch_source_t;
+
+typedef void (*fft_wire_write_t)(const uint8_t *data, size_t len);
+
+/* The last body of a delta-coded type, on either side of the link */
+typedef struct {
+    bool valid;
+    uint8_t seq;        // frame it came from
+    uint8_t countdown;  // frames until the next full one (encoder)
+    uint16_t length;
+    uint8_t body[FFT_WIRE_DELTA_MAX];
+} fft_wire_reference_t;
+
+typedef struct {
+    fft_wire_write_t write;
+    bool delta;
+    uint8_t seq;
+    fft_wire_reference_t refs[2];  // samples, dB8 spectra
+    uint8_t scratch[FFT_WIRE_DELTA_MAX];
+} fft_wire_encoder_t;
+
+void fft_wire_init(fft_wire_encoder_t *enc, fft_wire_write_t write, bool delta);
+bool fft_wire_send_samples(fft_wire_encoder_t *enc, const uint8_t *samples, int count, uint32_t sample_rate, uint32_t time_us);
+bool fft_wire_send_spectrum_f32(fft_wire_encoder_t *enc, const float *power, int count, float first_hz, float step_hz);
+bool fft_wire_send_spectrum_q15(fft_wire_encoder_t *enc, const float *power, int count, float first_hz, float step_hz);
+bool fft_wire_send_spectrum_db8(fft_wire_encoder_t *enc, const uint8_t *db, int count, float first_hz, float step_hz);
+bool fft_wire_send_pitch(fft_wire_encoder_t *enc, float frequency, float clarity, fft_wire_pitch_source_t source);
+
+/* A decoded frame; payload is valid until the next byte is fed */
+typedef struct {
+    uint8_t type;  // without FFT_WIRE_DELTA
+    uint8_t seq;
+    uint16_t length;
+    const uint8_t *payload;
+} fft_wire_frame_t;
+
+typedef struct {
+    int state;
+    uint16_t length;
+    uint16_t start;  // first byte of the frame being read
+    uint16_t scan;   // next byte to look at; bytes up to 'end' wait for a rescan
+    uint16_t end;
+    uint8_t buf[FFT_WIRE_MAX_FRAME];
+    fft_wire_reference_t refs[2];
+    uint8_t delta_out[FFT_WIRE_DELTA_MAX + 8];
+    uint32_t frames;
+    uint32_t crc_errors;
+    uint32_t missing_references;  // delta frames dropped for want of the frame they refer to
+} fft_wire_decoder_t;
+
+typedef struct {
+    uint8_t type;
+    float first_hz;
+    float step_hz;
+    int count;
+    const uint8_t *values;
+} fft_wire_spectrum_t;
+
+void fft_wire_decoder_init(fft_wire_decoder_t *dec);
+bool fft_wire_decode(fft_wire_decoder_t *dec, uint8_t byte, fft_wire_frame_t *frame);
+bool fft_wire_decode_flush(fft_wire_decoder_t *dec, fft_wire_frame_t *frame);
+bool fft_wire_get_samples(const fft_wire_frame_t *frame, uint32_t *sample_rate, uint32_t *time_us, const uint8_t **samples, int *count);
+bool fft_wire_get_spectrum(const fft_wire_frame_t *frame, fft_wire_spectrum_t *spectrum);
+float fft_wire_spectrum_power(const fft_wire_spectrum_t *spectrum, int index);
+bool fft_wire_get_pitch(const fft_wire_frame_t *frame, float *frequency, float *clarity, uint8_t *source);
+uint16_t fft_wire_crc16(uint16_t crc, const uint8_t *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FFT_WIRE_H */
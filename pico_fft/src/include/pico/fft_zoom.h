@@ -0,0 +1,37 @@
+#ifndef FFT_ZOOM_H
+#define FFT_ZOOM_H
+
+#include "pico/fft.h"
+
+/*
+ * Zoom analysis with the chirp-z transform: evaluates the DFT of nsamp
+ * samples at 'points' evenly spaced frequencies between freq_min and
+ * freq_max, at any spacing. The chirp convolution runs through kiss_fft
+ * with one FFT size of at least nsamp + points - 1.
+ */
+
+typedef struct {
+    int nsamp;
+    int points;
+    int nfft;            // convolution length
+    float freq_min;
+    float freq_step;
+    kiss_fft_cfg cfg;    // forward only; the inverse is done by conjugation
+    kiss_fft_cpx *pre;   // input chirp, nsamp
+    kiss_fft_cpx *post;  // output chirp, points
+    kiss_fft_cpx *filter;// transformed conjugate chirp, scaled by 1/nfft
+    kiss_fft_cpx *work;  // nfft, transformed in place
+} fft_zoom_t;
+
+/* Upper bound for fft_zoom_init's 'mem'; the exact size is returned in *lenmem */
+#define FFT_ZOOM_NFFT_MAX(nsamp, points) ((((nsamp) + (points)) * 3) / 2)
+#define FFT_ZOOM_MEM_SIZE(nsamp, points) \
+    ((2 + 2 * 32) * sizeof(int) + 2 * sizeof(void *) + 16 + \
+     (sizeof(kiss_fft_cpx) * 3 + 4) * FFT_ZOOM_NFFT_MAX(nsamp, points) + \
+     sizeof(kiss_fft_cpx) * ((nsamp) + (points)))
+
+bool fft_zoom_init(fft_zoom_t *zoom, int nsamp, float freq_min, float freq_max, int points, void *mem, size_t *lenmem);
+void fft_zoom_process(fft_zoom_t *zoom, const uint8_t *samples, kiss_fft_cpx *out);
+float fft_zoom_frequency(const fft_zoom_t *zoom, int index);
+
+#endif /* FFT_ZOOM_H */
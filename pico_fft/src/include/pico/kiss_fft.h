@@ -36,6 +36,13 @@ extern "C" {
 # define kiss_fft_scalar __m128
 #define KISS_FFT_MALLOC(nbytes) _mm_malloc(nbytes,16)
 #define KISS_FFT_FREE _mm_free
+#elif defined(KISS_FFT_LANES)
+/* KISS_FFT_LANES independent float transforms, one per lane of a GCC vector.
+   The alignment is lowered to a float's so plans need no special allocator. */
+typedef float kiss_fft_lanes __attribute__((vector_size(KISS_FFT_LANES * sizeof(float)), aligned(sizeof(float))));
+# define kiss_fft_scalar kiss_fft_lanes
+#define KISS_FFT_MALLOC malloc
+#define KISS_FFT_FREE free
 #else
 #define KISS_FFT_MALLOC malloc
 #define KISS_FFT_FREE free
@@ -88,6 +95,14 @@ typedef struct kiss_fft_state* kiss_fft_cfg;
 
 kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem);
 
+/*
+ *  kiss_fft_alloc_static
+ *
+ *  Same as kiss_fft_alloc, but the nfft twiddles come from the caller (e.g. a
+ *  const table in flash) and are neither computed nor copied.
+ */
+kiss_fft_cfg kiss_fft_alloc_static(int nfft,int inverse_fft,const kiss_fft_cpx * twiddles,void * mem,size_t * lenmem);
+
 /*
  * kiss_fft(cfg,in_out_buf)
  *
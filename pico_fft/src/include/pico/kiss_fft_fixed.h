@@ -0,0 +1,57 @@
+/*
+ * Fixed-point builds of kiss_fft/kiss_fftr (kiss_fft_q15.c, kiss_fft_q31.c).
+ *
+ * They follow the float API in kiss_fft.h and kiss_fftr.h with the type suffix
+ * in every name, so both builds can be linked into the same program. Forward
+ * transforms scale their output by 1/nfft to stay within range.
+ */
+
+#ifndef KISS_FFT_FIXED_H
+#define KISS_FFT_FIXED_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int16_t r;
+    int16_t i;
+} kiss_fft_q15_cpx;
+
+typedef struct kiss_fft_q15_state *kiss_fft_q15_cfg;
+typedef struct kiss_fftr_q15_state *kiss_fftr_q15_cfg;
+
+kiss_fft_q15_cfg kiss_fft_q15_alloc(int nfft, int inverse_fft, void *mem, size_t *lenmem);
+void kiss_fft_q15(kiss_fft_q15_cfg cfg, const kiss_fft_q15_cpx *fin, kiss_fft_q15_cpx *fout);
+kiss_fft_q15_cfg kiss_fft_q15_alloc_static(int nfft, int inverse_fft, const kiss_fft_q15_cpx *twiddles, void *mem, size_t *lenmem);
+kiss_fftr_q15_cfg kiss_fftr_q15_alloc(int nfft, int inverse_fft, void *mem, size_t *lenmem);
+kiss_fftr_q15_cfg kiss_fftr_q15_alloc_static(int nfft, int inverse_fft, const kiss_fft_q15_cpx *twiddles,
+                                           const kiss_fft_q15_cpx *super_twiddles, void *mem, size_t *lenmem);
+void kiss_fftr_q15(kiss_fftr_q15_cfg cfg, const int16_t *timedata, kiss_fft_q15_cpx *freqdata);
+void kiss_fftri_q15(kiss_fftr_q15_cfg cfg, const kiss_fft_q15_cpx *freqdata, int16_t *timedata);
+
+typedef struct {
+    int32_t r;
+    int32_t i;
+} kiss_fft_q31_cpx;
+
+typedef struct kiss_fft_q31_state *kiss_fft_q31_cfg;
+typedef struct kiss_fftr_q31_state *kiss_fftr_q31_cfg;
+
+kiss_fft_q31_cfg kiss_fft_q31_alloc(int nfft, int inverse_fft, void *mem, size_t *lenmem);
+void kiss_fft_q31(kiss_fft_q31_cfg cfg, const kiss_fft_q31_cpx *fin, kiss_fft_q31_cpx *fout);
+kiss_fft_q31_cfg kiss_fft_q31_alloc_static(int nfft, int inverse_fft, const kiss_fft_q31_cpx *twiddles, void *mem, size_t *lenmem);
+kiss_fftr_q31_cfg kiss_fftr_q31_alloc(int nfft, int inverse_fft, void *mem, size_t *lenmem);
+kiss_fftr_q31_cfg kiss_fftr_q31_alloc_static(int nfft, int inverse_fft, const kiss_fft_q31_cpx *twiddles,
+                                           const kiss_fft_q31_cpx *super_twiddles, void *mem, size_t *lenmem);
+void kiss_fftr_q31(kiss_fftr_q31_cfg cfg, const int32_t *timedata, kiss_fft_q31_cpx *freqdata);
+void kiss_fftri_q31(kiss_fftr_q31_cfg cfg, const kiss_fft_q31_cpx *freqdata, int32_t *timedata);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KISS_FFT_FIXED_H */
@@ -33,6 +33,13 @@ kiss_fftr_cfg kiss_fftr_alloc(int nfft,int inverse_fft,void * mem, size_t * lenm
  If you don't care to allocate space, use mem = lenmem = NULL
 */
 
+kiss_fftr_cfg kiss_fftr_alloc_static(int nfft,int inverse_fft,const kiss_fft_cpx * twiddles,
+                                     const kiss_fft_cpx * super_twiddles,void * mem,size_t * lenmem);
+/*
+ Same as kiss_fftr_alloc, but with precomputed nfft/2 twiddles and nfft/4
+ super twiddles (e.g. const tables in flash) that are neither computed nor copied
+*/
+
 
 void kiss_fftr(kiss_fftr_cfg cfg,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata);
 /*
@@ -26,7 +26,7 @@ static void kf_bfly2(
         )
 {
     kiss_fft_cpx * Fout2;
-    kiss_fft_cpx * tw1 = st->twiddles;
+    const kiss_fft_cpx * tw1 = st->twiddles;
     kiss_fft_cpx t;
     Fout2 = Fout + m;
     do{
@@ -48,7 +48,7 @@ static void kf_bfly4(
         const size_t m
         )
 {
-    kiss_fft_cpx *tw1,*tw2,*tw3;
+    const kiss_fft_cpx *tw1,*tw2,*tw3;
     kiss_fft_cpx scratch[6];
     size_t k=m;
     const size_t m2=2*m;
@@ -98,7 +98,7 @@ static void kf_bfly3(
 {
      size_t k=m;
      const size_t m2 = 2*m;
-     kiss_fft_cpx *tw1,*tw2;
+     const kiss_fft_cpx *tw1,*tw2;
      kiss_fft_cpx scratch[5];
      kiss_fft_cpx epi3;
      epi3 = st->twiddles[fstride*m];
@@ -143,8 +143,8 @@ static void kf_bfly5(
     kiss_fft_cpx *Fout0,*Fout1,*Fout2,*Fout3,*Fout4;
     int u;
     kiss_fft_cpx scratch[13];
-    kiss_fft_cpx * twiddles = st->twiddles;
-    kiss_fft_cpx *tw;
+    const kiss_fft_cpx * twiddles = st->twiddles;
+    const kiss_fft_cpx *tw;
     kiss_fft_cpx ya,yb;
     ya = twiddles[fstride*m];
     yb = twiddles[fstride*2*m];
@@ -204,11 +204,14 @@ static void kf_bfly_generic(
         )
 {
     int u,k,q1,q;
-    kiss_fft_cpx * twiddles = st->twiddles;
+    const kiss_fft_cpx * twiddles = st->twiddles;
     kiss_fft_cpx t;
     int Norig = st->nfft;
+    kiss_fft_cpx stack_scratch[KF_GENERIC_STACK_RADIX];
 
-    kiss_fft_cpx * scratch = (kiss_fft_cpx*)KISS_FFT_TMP_ALLOC(sizeof(kiss_fft_cpx)*p);
+    /* only radices above KF_GENERIC_STACK_RADIX need a temporary buffer */
+    kiss_fft_cpx * scratch = p <= KF_GENERIC_STACK_RADIX ? stack_scratch
+        : (kiss_fft_cpx*)KISS_FFT_TMP_ALLOC(sizeof(kiss_fft_cpx)*p);
 
     for ( u=0; u<m; ++u ) {
         k=u;
@@ -231,73 +234,142 @@ static void kf_bfly_generic(
             k += m;
         }
     }
-    KISS_FFT_TMP_FREE(scratch);
+    if (scratch != stack_scratch)
+        KISS_FFT_TMP_FREE(scratch);
 }
 
-static
-void kf_work(
+/* Copies the input into digit-reversed order, the order the leaves of the
+   recursive decimation in time would write it: output j = sum q[l]*m[l]
+   takes input sum q[l]*(p[0]*...*p[l-1]). A mixed radix counter over the
+   digits q[l] keeps the input position without any division. */
+static void kf_gather(
         kiss_fft_cpx * Fout,
         const kiss_fft_cpx * f,
-        const size_t fstride,
         int in_stride,
-        int * factors,
         const kiss_fft_cfg st
         )
 {
-    kiss_fft_cpx * Fout_beg=Fout;
-    const int p=*factors++; /* the radix  */
-    const int m=*factors++; /* stage's fft length/p */
-    const kiss_fft_cpx * Fout_end = Fout + p*m;
+    int p[MAXFACTORS], q[MAXFACTORS];
+    size_t w[MAXFACTORS];
+    size_t stride = in_stride;
+    const int * factors = st->factors;
+    const kiss_fft_cpx * Fout_end = Fout + st->nfft;
+    int levels = 0;
 
-#ifdef _OPENMP
-    // use openmp extensions at the
-    // top-level (not recursive)
-    if (fstride==1 && p<=5)
-    {
-        int k;
+    do {
+        p[levels] = factors[0];
+        q[levels] = 0;
+        w[levels] = stride;
+        stride *= factors[0];
+        ++levels;
+        factors += 2;
+    } while (factors[-1] != 1);
 
-        // execute the p different work units in different threads
-#       pragma omp parallel for
-        for (k=0;k<p;++k)
-            kf_work( Fout +k*m, f+ fstride*in_stride*k,fstride*p,in_stride,factors,st);
-        // all threads have joined by this point
-
-        switch (p) {
-            case 2: kf_bfly2(Fout,fstride,st,m); break;
-            case 3: kf_bfly3(Fout,fstride,st,m); break;
-            case 4: kf_bfly4(Fout,fstride,st,m); break;
-            case 5: kf_bfly5(Fout,fstride,st,m); break;
-            default: kf_bfly_generic(Fout,fstride,st,m,p); break;
+    do {
+        int l = levels - 1;
+        *Fout = *f;
+        while (l >= 0 && ++q[l] == p[l]) {
+            q[l] = 0;
+            f -= (p[l] - 1) * w[l];
+            --l;
         }
-        return;
+        if (l >= 0)
+            f += w[l];
+    } while (++Fout != Fout_end);
+}
+
+/* The same permutation done in place by rotating each cycle of the table */
+static void kf_permute(kiss_fft_cpx * Fout, const unsigned short * cycles)
+{
+    while (*cycles != KF_CYCLE_END) {
+        const unsigned short * c = cycles;
+        kiss_fft_cpx first = Fout[*c];
+        while (c[1] != KF_CYCLE_END) {
+            Fout[c[0]] = Fout[c[1]];
+            ++c;
+        }
+        Fout[*c] = first;
+        cycles = c + 2;
     }
-#endif
+}
 
-    if (m==1) {
-        do{
-            *Fout = *f;
-            f += fstride*in_stride;
-        }while(++Fout != Fout_end );
-    }else{
-        do{
-            // recursive call:
-            // DFT of size m*p performed by doing
-            // p instances of smaller DFTs of size m,
-            // each one takes a decimated version of the input
-            kf_work( Fout , f, fstride*p, in_stride, factors,st);
-            f += fstride*in_stride;
-        }while( (Fout += m) != Fout_end );
+/* Source index of output j in the digit-reversed order */
+static int kf_reversed_index(int j, const int * factors)
+{
+    int src = 0;
+    int w = 1;
+    do {
+        const int p = factors[0];
+        const int m = factors[1];
+        src += (j / m) * w;
+        j %= m;
+        w *= p;
+        factors += 2;
+    } while (factors[-1] != 1);
+    return src;
+}
+
+/* Writes the cycle table for st into cycles; a bitmap of visited indices
+   follows the largest possible table */
+static void kf_build_cycles(kiss_fft_cfg st, unsigned short * cycles)
+{
+    const int nfft = st->nfft;
+    unsigned char * seen = (unsigned char *)(cycles + nfft + nfft / 2 + 2);
+    int i;
+
+    memset(seen, 0, (nfft + 7) / 8);
+    st->cycles = cycles;
+    for (i = 0; i < nfft; ++i) {
+        int j = i;
+        if (seen[i >> 3] & (1 << (i & 7)))
+            continue;
+        if (kf_reversed_index(i, st->factors) == i)
+            continue;
+        do {
+            seen[j >> 3] |= 1 << (j & 7);
+            *cycles++ = (unsigned short)j;
+            j = kf_reversed_index(j, st->factors);
+        } while (j != i);
+        *cycles++ = KF_CYCLE_END;
     }
+    *cycles = KF_CYCLE_END;
+}
 
-    Fout=Fout_beg;
+/* Runs the butterflies over data already in digit-reversed order, deepest
+   stage first. Each stage works on nfft/(p*m) independent blocks, exactly the
+   calls the recursive kf_work made, so the outputs are unchanged. */
+static void kf_stages(kiss_fft_cpx * Fout, const kiss_fft_cfg st)
+{
+    size_t fstride[MAXFACTORS];
+    const int * factors = st->factors;
+    int levels = 0;
+    int l;
+
+    fstride[0] = 1;
+    while (factors[2 * levels + 1] != 1) {
+        fstride[levels + 1] = fstride[levels] * factors[2 * levels];
+        ++levels;
+    }
+
+    for (l = levels; l >= 0; --l) {
+        const int p = factors[2 * l];
+        const int m = factors[2 * l + 1];
+        const int blocks = (int)fstride[l];
+        int b;
 
-    // recombine the p smaller DFTs
-    switch (p) {
-        case 2: kf_bfly2(Fout,fstride,st,m); break;
-        case 3: kf_bfly3(Fout,fstride,st,m); break;
-        case 4: kf_bfly4(Fout,fstride,st,m); break;
-        case 5: kf_bfly5(Fout,fstride,st,m); break;
-        default: kf_bfly_generic(Fout,fstride,st,m,p); break;
+#ifdef _OPENMP
+#       pragma omp parallel for
+#endif
+        for (b = 0; b < blocks; ++b) {
+            kiss_fft_cpx * F = Fout + (size_t)b * p * m;
+            switch (p) {
+                case 2: kf_bfly2(F,fstride[l],st,m); break;
+                case 3: kf_bfly3(F,fstride[l],st,m); break;
+                case 4: kf_bfly4(F,fstride[l],st,m); break;
+                case 5: kf_bfly5(F,fstride[l],st,m); break;
+                default: kf_bfly_generic(F,fstride[l],st,m,p); break;
+            }
+        }
     }
 }
 
@@ -340,7 +412,8 @@ kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem
 {
     kiss_fft_cfg st=NULL;
     size_t memneeded = sizeof(struct kiss_fft_state)
-        + sizeof(kiss_fft_cpx)*(nfft-1); /* twiddle factors*/
+        + sizeof(kiss_fft_cpx)*nfft /* twiddle factors*/
+        + KF_CYCLES_SIZE(nfft);
 
     if ( lenmem==NULL ) {
         st = ( kiss_fft_cfg)KISS_FFT_MALLOC( memneeded );
@@ -351,18 +424,52 @@ kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem
     }
     if (st) {
         int i;
+        kiss_fft_cpx * twiddles = (kiss_fft_cpx *)(st + 1);
         st->nfft=nfft;
         st->inverse = inverse_fft;
+        st->twiddles = twiddles;
 
         for (i=0;i<nfft;++i) {
             const double pi=3.141592653589793238462643383279502884197169399375105820974944;
             double phase = -2*pi*i / nfft;
             if (st->inverse)
                 phase *= -1;
-            kf_cexp(st->twiddles+i, phase );
+            kf_cexp(twiddles+i, phase );
         }
 
         kf_factor(nfft,st->factors);
+        st->cycles = NULL;
+        if (KF_CYCLES_SIZE(nfft))
+            kf_build_cycles(st, (unsigned short *)(twiddles + nfft));
+    }
+    return st;
+}
+
+/*
+ * Like kiss_fft_alloc, but uses nfft precomputed twiddles (e.g. a const table
+ * in flash) instead of computing and storing them. Only the state and its
+ * cycle table are placed into mem.
+ * */
+kiss_fft_cfg kiss_fft_alloc_static(int nfft,int inverse_fft,const kiss_fft_cpx * twiddles,void * mem,size_t * lenmem )
+{
+    kiss_fft_cfg st=NULL;
+    size_t memneeded = sizeof(struct kiss_fft_state) + KF_CYCLES_SIZE(nfft);
+
+    if ( lenmem==NULL ) {
+        st = ( kiss_fft_cfg)KISS_FFT_MALLOC( memneeded );
+    }else{
+        if (mem != NULL && *lenmem >= memneeded)
+            st = (kiss_fft_cfg)mem;
+        *lenmem = memneeded;
+    }
+    if (st) {
+        st->nfft=nfft;
+        st->inverse = inverse_fft;
+        st->twiddles = twiddles;
+        kf_factor(nfft,st->factors);
+        st->cycles = NULL;
+        if (KF_CYCLES_SIZE(nfft))
+            kf_build_cycles(st, (unsigned short *)(st + 1));
     }
     return st;
 }
@@ -370,16 +477,20 @@ kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem
 
 void kiss_fft_stride(kiss_fft_cfg st,const kiss_fft_cpx *fin,kiss_fft_cpx *fout,int in_stride)
 {
-    if (fin == fout) {
-        //NOTE: this is not really an in-place FFT algorithm.
-        //It just performs an out-of-place FFT into a temp buffer
+    if (fin != fout) {
+        kf_gather(fout,fin,in_stride,st);
+    }else if (st->cycles && in_stride == 1) {
+        kf_permute(fout,st->cycles);
+    }else{
+        // No cycle table for this size: go through a temp buffer
         kiss_fft_cpx * tmpbuf = (kiss_fft_cpx*)KISS_FFT_TMP_ALLOC( sizeof(kiss_fft_cpx)*st->nfft);
-        kf_work(tmpbuf,fin,1,in_stride, st->factors,st);
+        kf_gather(tmpbuf,fin,in_stride,st);
+        kf_stages(tmpbuf,st);
         memcpy(fout,tmpbuf,sizeof(kiss_fft_cpx)*st->nfft);
         KISS_FFT_TMP_FREE(tmpbuf);
-    }else{
-        kf_work( fout, fin, 1,in_stride, st->factors,st );
+        return;
     }
+    kf_stages(fout,st);
 }
 
 void kiss_fft(kiss_fft_cfg cfg,const kiss_fft_cpx *fin,kiss_fft_cpx *fout)
@@ -0,0 +1,10 @@
+/*
+ * Q15 build of kiss_fft and kiss_fftr, declared in pico/kiss_fft_fixed.h.
+ */
+
+#define FIXED_POINT 16
+#define KISS_FFT_SUFFIX q15
+#include "kiss_fft_rename.h"
+
+#include "kiss_fft.c"
+#include "kiss_fftr.c"
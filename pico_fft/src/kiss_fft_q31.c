@@ -0,0 +1,10 @@
+/*
+ * Q31 build of kiss_fft and kiss_fftr, declared in pico/kiss_fft_fixed.h.
+ */
+
+#define FIXED_POINT 32
+#define KISS_FFT_SUFFIX q31
+#include "kiss_fft_rename.h"
+
+#include "kiss_fft.c"
+#include "kiss_fftr.c"
@@ -0,0 +1,31 @@
+/*
+ * Renames the public kiss_fft symbols so that another build of kiss_fft.c and
+ * kiss_fftr.c (e.g. FIXED_POINT) can be linked next to the default float one.
+ * Define KISS_FFT_SUFFIX before including this file; with a suffix of q15,
+ * kiss_fftr_alloc becomes kiss_fftr_q15_alloc and kiss_fft_cpx becomes
+ * kiss_fft_q15_cpx.
+ */
+
+#ifndef KISS_FFT_RENAME_H
+#define KISS_FFT_RENAME_H
+
+#define KISS_FFT_RENAME_(prefix, suffix, name) prefix##suffix##name
+#define KISS_FFT_RENAME(prefix, suffix, name) KISS_FFT_RENAME_(prefix, suffix, name)
+
+#define kiss_fft_cpx            KISS_FFT_RENAME(kiss_fft_, KISS_FFT_SUFFIX, _cpx)
+#define kiss_fft_state          KISS_FFT_RENAME(kiss_fft_, KISS_FFT_SUFFIX, _state)
+#define kiss_fft_cfg            KISS_FFT_RENAME(kiss_fft_, KISS_FFT_SUFFIX, _cfg)
+#define kiss_fft_alloc          KISS_FFT_RENAME(kiss_fft_, KISS_FFT_SUFFIX, _alloc)
+#define kiss_fft_alloc_static   KISS_FFT_RENAME(kiss_fft_, KISS_FFT_SUFFIX, _alloc_static)
+#define kiss_fft                KISS_FFT_RENAME(kiss_fft_, KISS_FFT_SUFFIX, )
+#define kiss_fft_stride         KISS_FFT_RENAME(kiss_fft_, KISS_FFT_SUFFIX, _stride)
+#define kiss_fft_cleanup        KISS_FFT_RENAME(kiss_fft_, KISS_FFT_SUFFIX, _cleanup)
+#define kiss_fft_next_fast_size KISS_FFT_RENAME(kiss_fft_, KISS_FFT_SUFFIX, _next_fast_size)
+#define kiss_fftr_state         KISS_FFT_RENAME(kiss_fftr_, KISS_FFT_SUFFIX, _state)
+#define kiss_fftr_cfg           KISS_FFT_RENAME(kiss_fftr_, KISS_FFT_SUFFIX, _cfg)
+#define kiss_fftr_alloc         KISS_FFT_RENAME(kiss_fftr_, KISS_FFT_SUFFIX, _alloc)
+#define kiss_fftr_alloc_static  KISS_FFT_RENAME(kiss_fftr_, KISS_FFT_SUFFIX, _alloc_static)
+#define kiss_fftr               KISS_FFT_RENAME(kiss_fftr_, KISS_FFT_SUFFIX, )
+#define kiss_fftri              KISS_FFT_RENAME(kiss_fftri_, KISS_FFT_SUFFIX, )
+
+#endif /* KISS_FFT_RENAME_H */
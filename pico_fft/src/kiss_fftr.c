@@ -15,19 +15,11 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "pico/kiss_fftr.h"
 #include "pico/_kiss_fft_guts.h"
 
-struct kiss_fftr_state{
-    kiss_fft_cfg substate;
-    kiss_fft_cpx * tmpbuf;
-    kiss_fft_cpx * super_twiddles;
-#ifdef USE_SIMD
-    void * pad;
-#endif
-};
-
 kiss_fftr_cfg kiss_fftr_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem)
 {
     int i;
     kiss_fftr_cfg st = NULL;
+    kiss_fft_cpx * super_twiddles;
     size_t subsize, memneeded;
 
     if (nfft & 1) {
@@ -51,7 +43,8 @@ kiss_fftr_cfg kiss_fftr_alloc(int nfft,int inverse_fft,void * mem,size_t * lenme
 
     st->substate = (kiss_fft_cfg) (st + 1); /*just beyond kiss_fftr_state struct */
     st->tmpbuf = (kiss_fft_cpx *) (((char *) st->substate) + subsize);
-    st->super_twiddles = st->tmpbuf + nfft;
+    super_twiddles = st->tmpbuf + nfft;
+    st->super_twiddles = super_twiddles;
     kiss_fft_alloc(nfft, inverse_fft, st->substate, &subsize);
 
     for (i = 0; i < nfft/2; ++i) {
@@ -59,8 +52,45 @@ kiss_fftr_cfg kiss_fftr_alloc(int nfft,int inverse_fft,void * mem,size_t * lenme
             -3.14159265358979323846264338327 * ((double) (i+1) / nfft + .5);
         if (inverse_fft)
             phase *= -1;
-        kf_cexp (st->super_twiddles+i,phase);
+        kf_cexp (super_twiddles+i,phase);
+    }
+    return st;
+}
+
+/*
+ * Like kiss_fftr_alloc, but points at precomputed tables: nfft/2 twiddles for
+ * the complex sub-FFT and nfft/4 super twiddles. Only the state and the
+ * nfft/2 point work buffer are placed into mem.
+ */
+kiss_fftr_cfg kiss_fftr_alloc_static(int nfft,int inverse_fft,const kiss_fft_cpx * twiddles,
+                                     const kiss_fft_cpx * super_twiddles,void * mem,size_t * lenmem)
+{
+    kiss_fftr_cfg st = NULL;
+    size_t subsize, memneeded;
+
+    if (nfft & 1) {
+        fprintf(stderr,"Real FFT optimization must be even.\n");
+        return NULL;
+    }
+    nfft >>= 1;
+
+    kiss_fft_alloc_static (nfft, inverse_fft, twiddles, NULL, &subsize);
+    memneeded = sizeof(struct kiss_fftr_state) + subsize + sizeof(kiss_fft_cpx) * nfft;
+
+    if (lenmem == NULL) {
+        st = (kiss_fftr_cfg) KISS_FFT_MALLOC (memneeded);
+    } else {
+        if (*lenmem >= memneeded)
+            st = (kiss_fftr_cfg) mem;
+        *lenmem = memneeded;
     }
+    if (!st)
+        return NULL;
+
+    st->substate = (kiss_fft_cfg) (st + 1); /*just beyond kiss_fftr_state struct */
+    st->tmpbuf = (kiss_fft_cpx *) (((char *) st->substate) + subsize);
+    st->super_twiddles = super_twiddles;
+    kiss_fft_alloc_static(nfft, inverse_fft, twiddles, st->substate, &subsize);
     return st;
 }
 
@@ -98,6 +128,8 @@ void kiss_fftr(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *fr
     freqdata[ncfft].r = tdc.r - tdc.i;
 #ifdef USE_SIMD
     freqdata[ncfft].i = freqdata[0].i = _mm_set1_ps(0);
+#elif defined(KISS_FFT_LANES)
+    freqdata[ncfft].i = freqdata[0].i = (kiss_fft_scalar){0};
 #else
     freqdata[ncfft].i = freqdata[0].i = 0;
 #endif
@@ -151,6 +183,8 @@ void kiss_fftri(kiss_fftr_cfg st,const kiss_fft_cpx *freqdata,kiss_fft_scalar *t
         C_SUB (st->tmpbuf[ncfft - k], fek, fok);
 #ifdef USE_SIMD
         st->tmpbuf[ncfft - k].i *= _mm_set1_ps(-1.0);
+#elif defined(KISS_FFT_LANES)
+        st->tmpbuf[ncfft - k].i *= -1.0f;
 #else
         st->tmpbuf[ncfft - k].i *= -1;
 #endif
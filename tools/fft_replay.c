@@ -0,0 +1,165 @@
+/*
+ * Runs a recording (pico/fft_record.h) through the spectrum and pitch
+ * analysis at host speed and checks the results against those the device
+ * recorded. Built by the host build (host/CMakeLists.txt):
+ *
+ *   ./fft_replay capture.frec          # one line per frame
+ *   ./fft_replay -q -t 1 capture.frec  # summary only, pitch must agree within 1 cent
+ *
+ * The exit status is 1 when any frame disagrees with the device.
+ */
+#include "pico/fft.h"
+#include "pico/fft_pitch.h"
+#include "pico/fft_record.h"
+#include "pico/fft_wire.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SPECTRUM_TOLERANCE 1e-3f  // of the frame's strongest bin
+
+static kiss_fft_cpx spectrum[NSAMP / 2 + 1];
+
+static bool make_bank(const fft_record_header_t *header, fft_bin_bank_t *bank);
+static float cents_between(float a, float b);
+static float spectrum_error(const fft_bin_bank_t *bank, const float *recorded);
+
+int main(int argc, char **argv) {
+  bool quiet = false;
+  float tolerance_cents = 0.5f;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "qt:")) != -1) {
+    if (opt == 'q') {
+      quiet = true;
+    } else if (opt == 't') {
+      tolerance_cents = atof(optarg);
+    } else {
+      optind = argc;
+      break;
+    }
+  }
+  if (optind != argc - 1) {
+    fprintf(stderr, "usage: %s [-q] [-t cents] <recording>\n", argv[0]);
+    return 2;
+  }
+
+  int fd = open(argv[optind], O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    fprintf(stderr, "Failed to open %s\n", argv[optind]);
+    return 1;
+  }
+  // Private and writable because the processing functions take non-const buffers
+  void *data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  fft_recording_t rec;
+  if (data == MAP_FAILED || !fft_record_open(&rec, data, st.st_size)) {
+    return 1;
+  }
+  const fft_record_header_t *header = rec.header;
+  if (header->frame_samples != NSAMP || header->sample_rate != FSAMP) {
+    fprintf(stderr, "Recording has %u samples at %u Hz, this build analyses %d at %d Hz\n",
+            header->frame_samples, header->sample_rate, NSAMP, FSAMP);
+    return 1;
+  }
+
+  // Only pitches from the same detector can be expected to agree
+  bool check_pitch = (header->flags & FFT_RECORD_PITCH) && header->pitch_source == FFT_WIRE_PITCH_MPM;
+  if ((header->flags & FFT_RECORD_PITCH) && !check_pitch) {
+    fprintf(stderr, "Recorded pitches do not come from fft_pitch_detect, not comparing them\n");
+  }
+
+  fft_bin_bank_t bank;
+  fft_setup();
+  if (!make_bank(header, &bank)) {
+    return 1;
+  }
+
+  int pitch_mismatches = 0;
+  int spectrum_mismatches = 0;
+  uint64_t start = time_us_64();
+
+  for (uint32_t i = 0; i < rec.frame_count; i++) {
+    const fft_record_frame_t *frame = fft_record_frame(&rec, i);
+    uint8_t *samples = (uint8_t *)fft_record_samples(&rec, frame);
+    if (!samples) {
+      fprintf(stderr, "Recording has %u-bit samples, only 8-bit ones can be replayed\n", header->sample_bits);
+      return 1;
+    }
+    const float *recorded = fft_record_spectrum(&rec, frame);
+    fft_pitch_t pitch;
+    fft_peak_t peak;
+
+    fft_process_spectrum(samples, spectrum);
+    fft_bin_bank_accumulate_scaled(&bank, spectrum, FFT_SCALE_POWER);
+    if (!fft_find_peak(spectrum, FFT_PITCH_MIN_HZ / FFT_BIN_HZ, FFT_PITCH_MAX_HZ / FFT_BIN_HZ, FFT_PEAK_QUINN, &peak)) {
+      peak.frequency = 0;
+    }
+    fft_pitch_detect(samples + NSAMP - FFT_PITCH_NSAMP, &pitch);
+
+    bool pitch_ok = true;
+    if (check_pitch) {
+      if (pitch.frequency > 0 && frame->pitch_hz > 0) {
+        pitch_ok = fabsf(cents_between(pitch.frequency, frame->pitch_hz)) <= tolerance_cents;
+      } else {
+        pitch_ok = pitch.frequency == frame->pitch_hz;
+      }
+      pitch_mismatches += !pitch_ok;
+    }
+    float error = recorded ? spectrum_error(&bank, recorded) : 0;
+    spectrum_mismatches += error > SPECTRUM_TOLERANCE;
+
+    if (!quiet) {
+      printf("%u %.3f pitch %.2f Hz clarity %.2f peak %.2f Hz", i, frame->time_us * 1e-6, pitch.frequency,
+             pitch.clarity, peak.frequency);
+      if (check_pitch) {
+        printf(" device %.2f Hz%s", frame->pitch_hz, pitch_ok ? "" : " MISMATCH");
+      }
+      if (recorded) {
+        printf(" spectrum error %.2g%s", error, error > SPECTRUM_TOLERANCE ? " MISMATCH" : "");
+      }
+      printf("\n");
+    }
+  }
+
+  double seconds = (time_us_64() - start) * 1e-6;
+  fprintf(stderr, "%u frames in %.3f s (%.0f frames/s), %d pitch and %d spectrum mismatches\n", rec.frame_count,
+          seconds, seconds > 0 ? rec.frame_count / seconds : 0, pitch_mismatches, spectrum_mismatches);
+  return pitch_mismatches || spectrum_mismatches;
+}
+
+// The device's bins when it recorded a spectrum, otherwise one per FFT output
+static bool make_bank(const fft_record_header_t *header, fft_bin_bank_t *bank) {
+  int count = header->spectrum_count ? header->spectrum_count : NSAMP / 2;
+  float first = header->spectrum_count ? header->spectrum_first_hz : 0;
+  float step = header->spectrum_count ? header->spectrum_step_hz : FFT_BIN_HZ;
+  frequency_bin_t *bins = calloc(count, sizeof(*bins));
+  size_t lenmem = FFT_BIN_BANK_MEM_SIZE(count);
+  void *mem = malloc(lenmem);
+
+  for (int q = 0; q < count; q++) {
+    bins[q].name = "bin";
+    bins[q].freq_min = lroundf(first + (q - 0.5f) * step);
+    bins[q].freq_max = lroundf(first + (q + 0.5f) * step);
+  }
+  bool ok = fft_bin_bank_init(bank, bins, count, mem, &lenmem);
+  free(bins);
+  return ok;
+}
+
+static float cents_between(float a, float b) {
+  return 1200.0f * log2f(a / b);
+}
+
+static float spectrum_error(const fft_bin_bank_t *bank, const float *recorded) {
+  float largest = 0;
+  float error = 0;
+
+  for (int q = 0; q < bank->bin_count; q++) {
+    largest = fmaxf(largest, fabsf(recorded[q]));
+    error = fmaxf(error, fabsf(bank->amplitude[q] - recorded[q]));
+  }
+  return largest > 0 ? error / largest : error;
+}
@@ -0,0 +1,253 @@
+/*
+ * Prints the fft_wire frames sent by blink_any with TUNER_STREAM set, and
+ * optionally saves them as a recording (pico/fft_record.h).
+ *
+ *   cc -O2 -Ipico_fft/src/include tools/fft_wire_dump.c pico_fft/src/fft_wire.c pico_fft/src/fft_record.c -lm -o fft_wire_dump
+ *
+ * or as part of the host build (host/CMakeLists.txt).
+ *
+ *   ./fft_wire_dump /dev/ttyACM0                   # or a captured file, or - for stdin
+ *   ./fft_wire_dump -v /dev/ttyACM0                # also print every sample and spectrum value
+ *   ./fft_wire_dump -r capture.frec /dev/ttyACM0   # record until the stream ends or Ctrl-C
+ *
+ * One line per frame; counts of CRC errors and dropped delta frames go to
+ * stderr at the end of the stream. A recorded frame holds a samples frame
+ * together with the spectrum and pitch frames that follow it.
+ */
+#include "pico/fft_wire.h"
+#include "pico/fft_record.h"
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+static fft_wire_decoder_t decoder;
+static volatile sig_atomic_t interrupted;
+
+// The frame being assembled for the recording
+static struct {
+    bool valid;
+    uint64_t time_us;
+    uint32_t sample_rate;
+    int count;
+    uint8_t samples[FFT_WIRE_MAX_PAYLOAD];
+    bool has_spectrum;
+    int spectrum_count;
+    float first_hz;
+    float step_hz;
+    float spectrum[FFT_WIRE_MAX_PAYLOAD / sizeof(float)];
+    bool has_pitch;
+    float pitch_hz;
+    float clarity;
+    uint8_t pitch_source;
+} pending;
+
+static FILE *record_file;
+static fft_record_header_t record_header;
+static uint8_t *record_buf;
+static uint32_t record_frames;
+static uint32_t last_time_us;
+
+static int open_input(const char *path);
+static void on_interrupt(int sig);
+static void print_frame(const fft_wire_frame_t *frame, bool verbose);
+static void record_frame(const fft_wire_frame_t *frame);
+static void record_flush();
+static void record_finish();
+
+int main(int argc, char **argv) {
+  bool verbose = false;
+  const char *record_path = NULL;
+  uint8_t buf[4096];
+  fft_wire_frame_t frame;
+  ssize_t n;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "vr:")) != -1) {
+    if (opt == 'v') {
+      verbose = true;
+    } else if (opt == 'r') {
+      record_path = optarg;
+    } else {
+      optind = argc;
+      break;
+    }
+  }
+  if (optind != argc - 1) {
+    fprintf(stderr, "usage: %s [-v] [-r recording] <serial device | file | ->\n", argv[0]);
+    return 2;
+  }
+  const char *path = argv[optind];
+  int fd = open_input(path);
+  if (fd < 0) {
+    fprintf(stderr, "Failed to open %s\n", path);
+    return 1;
+  }
+  if (record_path && !(record_file = fopen(record_path, "wb"))) {
+    fprintf(stderr, "Failed to create %s\n", record_path);
+    return 1;
+  }
+
+  // No SA_RESTART, so Ctrl-C ends the read below and the recording is finished properly
+  struct sigaction sa = {0};
+  sa.sa_handler = on_interrupt;
+  sigaction(SIGINT, &sa, NULL);
+
+  fft_wire_decoder_init(&decoder);
+  while (!interrupted && (n = read(fd, buf, sizeof(buf))) > 0) {
+    for (ssize_t i = 0; i < n; i++) {
+      if (fft_wire_decode(&decoder, buf[i], &frame)) {
+        print_frame(&frame, verbose);
+        if (record_file) {
+          record_frame(&frame);
+        }
+      }
+    }
+    fflush(stdout);
+  }
+  // Frames that started inside a partial one at the very end
+  while (fft_wire_decode_flush(&decoder, &frame)) {
+    print_frame(&frame, verbose);
+    if (record_file) {
+      record_frame(&frame);
+    }
+  }
+  if (record_file) {
+    record_finish();
+  }
+
+  fprintf(stderr, "%u frames, %u CRC errors, %u delta frames without a reference\n",
+          decoder.frames, decoder.crc_errors, decoder.missing_references);
+  if (record_file) {
+    fprintf(stderr, "%u frames recorded to %s\n", record_frames, record_path);
+  }
+  return 0;
+}
+
+// Serial devices (and ptys standing in for one) are switched to raw mode
+static int open_input(const char *path) {
+  if (strcmp(path, "-") == 0) {
+    return STDIN_FILENO;
+  }
+  int fd = open(path, O_RDONLY | O_NOCTTY);
+  struct termios tio;
+
+  if (fd >= 0 && isatty(fd) && tcgetattr(fd, &tio) == 0) {
+    cfmakeraw(&tio);
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSANOW, &tio);
+  }
+  return fd;
+}
+
+static void on_interrupt(int sig) {
+  interrupted = 1;
+}
+
+static void print_frame(const fft_wire_frame_t *frame, bool verbose) {
+  uint32_t rate, time_us;
+  const uint8_t *samples;
+  int count;
+  fft_wire_spectrum_t spectrum;
+  float frequency, clarity;
+  uint8_t source;
+
+  if (fft_wire_get_samples(frame, &rate, &time_us, &samples, &count)) {
+    int lo = 255, hi = 0;
+    for (int i = 0; i < count; i++) {
+      lo = samples[i] < lo ? samples[i] : lo;
+      hi = samples[i] > hi ? samples[i] : hi;
+    }
+    printf("%3u samples %d at %u Hz, t %.3f s, range %d-%d\n", frame->seq, count, rate, time_us * 1e-6, lo, hi);
+    for (int i = 0; verbose && i < count; i++) {
+      printf("  %d %u\n", i, samples[i]);
+    }
+  } else if (fft_wire_get_spectrum(frame, &spectrum)) {
+    static const char *names[] = {"", "", "f32", "q15", "db8"};
+    int peak = 0;
+    for (int i = 1; i < spectrum.count; i++) {
+      if (fft_wire_spectrum_power(&spectrum, i) > fft_wire_spectrum_power(&spectrum, peak)) {
+        peak = i;
+      }
+    }
+    printf("%3u spectrum %s %d values from %.1f Hz every %.2f Hz, peak %.1f Hz\n", frame->seq,
+           names[spectrum.type], spectrum.count, spectrum.first_hz, spectrum.step_hz,
+           spectrum.first_hz + peak * spectrum.step_hz);
+    for (int i = 0; verbose && i < spectrum.count; i++) {
+      printf("  %.2f %g\n", spectrum.first_hz + i * spectrum.step_hz, fft_wire_spectrum_power(&spectrum, i));
+    }
+  } else if (fft_wire_get_pitch(frame, &frequency, &clarity, &source)) {
+    static const char *sources[] = {"unknown", "mpm", "spectrum", "goertzel"};
+    printf("%3u pitch %.2f Hz, clarity %.2f, %s\n", frame->seq, frequency, clarity,
+           source < 4 ? sources[source] : "unknown");
+  } else {
+    printf("%3u type %u, %u bytes\n", frame->seq, frame->type, frame->length);
+  }
+}
+
+static void record_frame(const fft_wire_frame_t *frame) {
+  uint32_t time_us;
+  const uint8_t *samples;
+  fft_wire_spectrum_t spectrum;
+
+  if (fft_wire_get_samples(frame, &pending.sample_rate, &time_us, &samples, &pending.count)) {
+    record_flush();
+    // The device clock wraps every 71 minutes
+    pending.time_us += pending.valid ? (uint32_t)(time_us - last_time_us) : time_us;
+    last_time_us = time_us;
+    memcpy(pending.samples, samples, pending.count);
+    pending.valid = true;
+    pending.has_spectrum = false;
+    pending.has_pitch = false;
+    pending.pitch_hz = 0;
+    pending.clarity = 0;
+  } else if (fft_wire_get_spectrum(frame, &spectrum) && pending.valid) {
+    for (int i = 0; i < spectrum.count; i++) {
+      pending.spectrum[i] = fft_wire_spectrum_power(&spectrum, i);
+    }
+    pending.has_spectrum = true;
+    pending.spectrum_count = spectrum.count;
+    pending.first_hz = spectrum.first_hz;
+    pending.step_hz = spectrum.step_hz;
+  } else if (fft_wire_get_pitch(frame, &pending.pitch_hz, &pending.clarity, &pending.pitch_source) && pending.valid) {
+    pending.has_pitch = true;
+  }
+}
+
+// The header follows the first frame; later frames that do not fit it are skipped
+static void record_flush() {
+  if (!pending.valid) {
+    return;
+  }
+  if (!record_buf) {
+    uint8_t flags = (pending.has_spectrum ? FFT_RECORD_SPECTRUM : 0) | (pending.has_pitch ? FFT_RECORD_PITCH : 0);
+    fft_record_header_init(&record_header, pending.sample_rate, pending.count, 8, flags, pending.spectrum_count,
+                           pending.first_hz, pending.step_hz);
+    record_header.pitch_source = pending.pitch_source;
+    record_buf = malloc(record_header.frame_size);
+    fwrite(&record_header, sizeof(record_header), 1, record_file);
+  }
+  if (pending.count != record_header.frame_samples || pending.sample_rate != record_header.sample_rate ||
+      (pending.has_spectrum && pending.spectrum_count != record_header.spectrum_count)) {
+    fprintf(stderr, "Skipping a frame that does not match the recording's format\n");
+    return;
+  }
+  fft_record_pack(&record_header, record_buf, pending.time_us, pending.samples,
+                  pending.has_spectrum ? pending.spectrum : NULL, pending.pitch_hz, pending.clarity);
+  fwrite(record_buf, record_header.frame_size, 1, record_file);
+  record_frames++;
+}
+
+static void record_finish() {
+  record_flush();
+  if (record_buf) {
+    record_header.frame_count = record_frames;
+    fseek(record_file, 0, SEEK_SET);
+    fwrite(&record_header, sizeof(record_header), 1, record_file);
+  }
+  fclose(record_file);
+}